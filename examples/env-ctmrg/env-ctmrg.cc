@@ -1,5 +1,6 @@
 #include "pi-peps/config.h"
 #include "json.hpp"
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -49,6 +50,22 @@ int main(int argc, char* argv[]) {
   // read CTMRG parameters
   auto json_ctmrg_params(jsonCls["ctmrg"]);
   int auxEnvDim = json_ctmrg_params["auxEnvDim"].get<int>();
+  // adaptive environment dimension, growing from auxEnvDimInit to auxEnvDim
+  // by chiStep until discarded weight drops below chiTruncErr
+  int arg_auxEnvDimInit = json_ctmrg_params.value("auxEnvDimInit", auxEnvDim);
+  int arg_chiStep = json_ctmrg_params.value("chiStep", auxEnvDim);
+  double arg_chiTruncErr = json_ctmrg_params.value("chiTruncErr", 0.0);
+  // chi ladder: converge at each x of auxEnvDimLadder in turn, starting
+  // from the environment converged at the previous one, embedded into
+  // larger x with relative noise chiNoise. The ladder ends at auxEnvDim.
+  // Overrides adaptive x
+  std::vector<int> chiLadder =
+    json_ctmrg_params.value("auxEnvDimLadder", std::vector<int>());
+  double arg_chiNoise = json_ctmrg_params.value("chiNoise", 0.0);
+  if (!chiLadder.empty()) {
+    chiLadder = makeChiLadder(chiLadder, auxEnvDim);
+    arg_auxEnvDimInit = chiLadder.front();
+  }
   CtmEnv::init_env_type arg_initEnvType(
     toINIT_ENV(json_ctmrg_params["initEnvType"].get<std::string>()));
   CtmEnv::isometry_type iso_type(
@@ -62,8 +79,50 @@ int main(int argc, char* argv[]) {
   auto rsvd_power = json_ctmrg_params.value("rsvd_power", 2);
   auto rsvd_reortho = json_ctmrg_params.value("rsvd_reortho", 1);
   auto rsvd_oversampling = json_ctmrg_params.value("rsvd_oversampling", 10);
+  int arg_warmstart_iter = json_ctmrg_params.value("warmstart_iter", 2);
+  double arg_warmstart_tol = json_ctmrg_params.value("warmstart_tol", 1.0e-6);
+  // choices of auto-tuned SVD solver persist across runs
+  std::string arg_autoSvdCache =
+    json_ctmrg_params.value("auto_svd_cache", "svd-autotune.json");
+  int arg_ctmThreads = json_ctmrg_params.value("ctmThreads", 1);
+  bool arg_layeredContraction =
+    json_ctmrg_params.value("layeredContraction", false);
+  bool arg_ctmSweep = json_ctmrg_params.value("ctmSweep", false);
+  // DIRECTIONAL, C4V (symmetric CTM of single-site cluster) or VUMPS
+  // (boundary MPS of single-site cluster)
+  std::string arg_ctmAlgorithm =
+    json_ctmrg_params.value("ctmAlgorithm", "DIRECTIONAL");
+  if (arg_ctmAlgorithm != "DIRECTIONAL" && arg_ctmAlgorithm != "C4V" &&
+      arg_ctmAlgorithm != "VUMPS")
+    throw std::runtime_error("Unsupported ctmAlgorithm: " + arg_ctmAlgorithm);
+  double arg_isoReuseTol = json_ctmrg_params.value("isoReuseTol", 0.0);
+  int arg_isoReuseMax = json_ctmrg_params.value("isoReuseMax", 4);
+  int arg_andersonDepth = json_ctmrg_params.value("andersonDepth", 0);
+  double arg_andersonMixing = json_ctmrg_params.value("andersonMixing", 1.0);
+  double arg_andersonRestart =
+    json_ctmrg_params.value("andersonRestart", 10.0);
+  bool arg_isoFixGauge =
+    json_ctmrg_params.value("isoFixGauge", arg_andersonDepth > 0);
   int arg_maxEnvIter = json_ctmrg_params["maxEnvIter"].get<int>();
   double arg_envEps = json_ctmrg_params["envEpsilon"].get<double>();
+  // convergence by spectral distance of corners, disabled for specEps <= 0,
+  // and frequency of (expensive) convergence check by boundary variance
+  double arg_specEps = json_ctmrg_params.value("specEpsilon", -1.0);
+  int arg_varianceCheckFreq =
+    std::max(1, json_ctmrg_params.value("varianceCheckFreq", 1));
+  // reduced-accuracy CTM until dSpec drops below lowPrecisionSwitch,
+  // disabled for lowPrecisionSwitch <= 0
+  double arg_lowPrecisionSwitch =
+    json_ctmrg_params.value("lowPrecisionSwitch", -1.0);
+  if (arg_lowPrecisionSwitch > 0.0 && !supportsLowPrecision(env_SVD_METHOD))
+    throw std::runtime_error(
+      "lowPrecisionSwitch > 0 requires an iterative env_SVD_METHOD "
+      "(warmstart, rsvd, rsvd-lapack, lanczos or arpack), got " +
+      env_SVD_METHOD);
+  // binary checkpoints of the environment, read by INIT_ENV_file and
+  // written once CTMRG is done
+  std::string arg_envFile = json_ctmrg_params.value("envFile", "");
+  std::string arg_outEnvFile = json_ctmrg_params.value("outEnvFile", "");
   bool arg_envDbg = json_ctmrg_params["dbg"].get<bool>();
   int arg_envDbgLvl = json_ctmrg_params["dbgLvl"].get<int>();
   // end reading CTMRG parameters
@@ -99,6 +158,8 @@ int main(int argc, char* argv[]) {
     p_cls = cf.create(json_cluster);
   }
   p_cls->normalize();
+  if (arg_ctmAlgorithm == "C4V")
+    p_cls->symmetrizeC4v();
   std::cout << *p_cls;
   // ***** INITIALIZE CLUSTER DONE ******************************************
 
@@ -140,11 +201,22 @@ int main(int argc, char* argv[]) {
   auto pSvdSolver = sf.create(env_SVD_METHOD);
 
   // CtmEnv ctmEnv(arg_ioEnvTag, auxEnvDim, cls, *pSvdSolver,
-  CtmEnv ctmEnv("default", auxEnvDim, *p_cls, *pSvdSolver,
+  CtmEnv ctmEnv("default", arg_auxEnvDimInit, *p_cls, *pSvdSolver,
                 {"isoPseudoInvCutoff", arg_isoPseudoInvCutoff, "SVD_METHOD",
                  env_SVD_METHOD, "rsvd_power", rsvd_power, "rsvd_reortho",
-                 rsvd_reortho, "rsvd_oversampling", rsvd_oversampling, "dbg",
-                 arg_envDbg, "dbgLevel", arg_envDbgLvl});
+                 rsvd_reortho, "rsvd_oversampling", rsvd_oversampling,
+                 "warmstart_iter", arg_warmstart_iter, "warmstart_tol",
+                 arg_warmstart_tol, "auto_svd_cache", arg_autoSvdCache,
+                 "ctmThreads", arg_ctmThreads,
+                 "layeredContraction", arg_layeredContraction,
+                 "isoReuseTol", arg_isoReuseTol, "isoReuseMax",
+                 arg_isoReuseMax, "andersonDepth", arg_andersonDepth,
+                 "andersonMixing", arg_andersonMixing, "andersonRestart",
+                 arg_andersonRestart, "isoFixGauge", arg_isoFixGauge, "chiMax",
+                 auxEnvDim, "chiStep", arg_chiStep, "chiTruncErr",
+                 arg_chiTruncErr, "chiNoise", arg_chiNoise,
+                 "lowPrecisionSwitch", arg_lowPrecisionSwitch, "envFile",
+                 arg_envFile, "dbg", arg_envDbg, "dbgLevel", arg_envDbgLvl});
   ctmEnv.init(arg_initEnvType, false, arg_envDbg);
 
   // INITIALIZE EXPECTATION VALUE BUILDER
@@ -154,116 +226,192 @@ int main(int argc, char* argv[]) {
 
   std::vector<double> diag_minCornerSV(1, 0.);
   bool expValEnvConv = false;
+  CtmEnv::CtmSpec specPrev;
   // PERFORM CTMRG
-  for (int envI = 1; envI <= arg_maxEnvIter; envI++) {
-    t_begin_int = std::chrono::steady_clock::now();
-
-    ctmEnv.move_unidirectional(CtmEnv::DIRECTION::LEFT, iso_type, accT);
-    // ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
-    ctmEnv.move_unidirectional(CtmEnv::DIRECTION::RIGHT, iso_type, accT);
-    ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
-    ctmEnv.move_unidirectional(CtmEnv::DIRECTION::DOWN, iso_type, accT);
-
-    t_end_int = std::chrono::steady_clock::now();
-    std::cout << "CTM STEP " << envI << " T: " << get_s(t_begin_int, t_end_int)
-              << " [sec] ";
+  ptr_model->setObservablesHeader(out_file_energy);
+  int const nRungs = std::max<int>(1, chiLadder.size());
+  for (int rung = 0; rung < nRungs; rung++) {
+    if (rung > 0) {
+      // continue from the environment converged at the previous x
+      ctmEnv.growChi(chiLadder[rung], arg_chiNoise);
+      expValEnvConv = false;
+      specPrev = CtmEnv::CtmSpec();
+      std::cout << "CHI LADDER x -> " << ctmEnv.x << std::endl;
+    }
 
-    // CHECK CONVERGENCE
-    if ((arg_maxEnvIter > 1) && (envI % 1 == 0)) {
+    for (int envI = 1; envI <= arg_maxEnvIter; envI++) {
       t_begin_int = std::chrono::steady_clock::now();
 
-      e_curr[0] =
-        analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::RIGHT);
-      e_curr[1] =
-        analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::DOWN);
-      e_curr[2] =
-        analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::RIGHT);
-      e_curr[3] =
-        analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::DOWN);
+      if (arg_ctmAlgorithm == "C4V") {
+        ctmEnv.move_c4v(accT);
+      } else if (arg_ctmAlgorithm == "VUMPS") {
+        ctmEnv.move_vumps(accT);
+      } else if (arg_ctmSweep) {
+        ctmEnv.sweep(iso_type, accT);
+      } else {
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::LEFT, iso_type, accT);
+        // ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::RIGHT, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::DOWN, iso_type, accT);
+      }
+      // the residual compares environments of consecutive steps, thus it
+      // is meaningful only if the gauge of the projectors is fixed
+      double envRes = -1.0;
+      if (ctmEnv.andersonDepth > 0 || ctmEnv.isoFixGauge)
+        envRes = ctmEnv.extrapolate();
 
       t_end_int = std::chrono::steady_clock::now();
-      std::cout << " || Var(boundary) in T: " << get_s(t_begin_int, t_end_int)
-                << " [sec] : " << e_curr[0] << " " << e_curr[1] << " "
-                << e_curr[2] << " " << e_curr[3] << std::endl;
-
-      // if the difference between energies along NN links is lower then
-      // arg_envEps consider the environment converged
-      if ((std::abs(e_prev[0] - e_curr[0]) < arg_envEps) &&
-          (std::abs(e_prev[1] - e_curr[1]) < arg_envEps) &&
-          (std::abs(e_prev[2] - e_curr[2]) < arg_envEps) &&
-          (std::abs(e_prev[3] - e_curr[3]) < arg_envEps)) {
-        expValEnvConv = true;
-        std::cout << " ENV CONVERGED ";
+      std::cout << "CTM STEP " << envI
+                << " T: " << get_s(t_begin_int, t_end_int) << " [sec] ";
+      if (envRes >= 0.0 && ctmEnv.isoFixGauge)
+        std::cout << "Res: " << envRes << " ";
+      if (arg_ctmAlgorithm == "VUMPS")
+        std::cout << "VErr: "
+                  << *std::max_element(ctmEnv.vumpsErr.begin(),
+                                       ctmEnv.vumpsErr.end())
+                  << " ";
+
+      // spectral distance to the spectra of previous step
+      double dSpec = ctmEnv.specDist(ctmEnv.spec, specPrev);
+      specPrev = ctmEnv.spec;
+      // not measured if projectors were reused
+      if (dSpec >= 0.0)
+        std::cout << "dSpec: " << dSpec << " ";
+      if (ctmEnv.switchPrecision(dSpec))
+        std::cout << "PREC -> double ";
+
+      // CHECK CONVERGENCE
+      if (arg_maxEnvIter > 1) {
+        if (envI % arg_varianceCheckFreq == 0) {
+          t_begin_int = std::chrono::steady_clock::now();
+
+          e_curr[0] =
+            analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::RIGHT);
+          e_curr[1] =
+            analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::DOWN);
+          e_curr[2] =
+            analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::RIGHT);
+          e_curr[3] =
+            analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::DOWN);
+
+          t_end_int = std::chrono::steady_clock::now();
+          std::cout << " || Var(boundary) in T: "
+                    << get_s(t_begin_int, t_end_int) << " [sec] : " << e_curr[0]
+                    << " " << e_curr[1] << " " << e_curr[2] << " " << e_curr[3]
+                    << std::endl;
+
+          // if the difference between energies along NN links is lower then
+          // arg_envEps consider the environment converged
+          if ((std::abs(e_prev[0] - e_curr[0]) < arg_envEps) &&
+              (std::abs(e_prev[1] - e_curr[1]) < arg_envEps) &&
+              (std::abs(e_prev[2] - e_curr[2]) < arg_envEps) &&
+              (std::abs(e_prev[3] - e_curr[3]) < arg_envEps)) {
+            expValEnvConv = true;
+            std::cout << " ENV CONVERGED ";
+          }
+          e_prev = e_curr;
+        }
+
+        if (arg_specEps > 0.0 && dSpec >= 0.0 && dSpec < arg_specEps) {
+          expValEnvConv = true;
+          std::cout << " SPEC CONVERGED ";
+        }
+
+        if (envI == arg_maxEnvIter) {
+          expValEnvConv = true;
+          std::cout << " MAX ENV iterations REACHED ";
+        }
+
+        // converged with reduced accuracy. Continue in double precision
+        if (expValEnvConv && envI < arg_maxEnvIter &&
+            ctmEnv.switchPrecision(0.0)) {
+          expValEnvConv = false;
+          std::cout << " PREC -> double ";
+        }
+
+        // converged for current x. Continue with larger x, if required.
+        // With the chi ladder x grows only between its rungs
+        if (expValEnvConv && envI < arg_maxEnvIter && chiLadder.empty() &&
+            ctmEnv.adaptChi()) {
+          expValEnvConv = false;
+          std::cout << " x -> " << ctmEnv.x << " ";
+        }
+
+        // Perform loop termination
+        if (expValEnvConv) {
+          diag_ctmIter.push_back(envI);
+
+          std::ostringstream oss;
+          oss << std::scientific;
+
+          // Compute spectra of Corner matrices
+          std::cout << std::endl;
+          double tmpVal;
+          double minCornerSV = 1.0e+16;
+          Args args_dbg_cornerSVD = {"Truncate", false};
+          std::cout << "Spectra: " << std::endl;
+
+          ITensor tL(
+            ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]).inds().front()),
+            sv, tR;
+          auto spec = svd(ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv,
+                          tR, args_dbg_cornerSVD);
+          tmpVal =
+            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+          PrintData(sv);
+          minCornerSV = std::min(minCornerSV, tmpVal);
+          oss << tmpVal;
+
+          tL = ITensor(
+            ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+          spec = svd(ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                     args_dbg_cornerSVD);
+          tmpVal =
+            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+          PrintData(sv);
+          minCornerSV = std::min(minCornerSV, tmpVal);
+          oss << " " << tmpVal;
+
+          tL = ITensor(
+            ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+          spec = svd(ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                     args_dbg_cornerSVD);
+          tmpVal =
+            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+          PrintData(sv);
+          minCornerSV = std::min(minCornerSV, tmpVal);
+          oss << " " << tmpVal;
+
+          tL = ITensor(
+            ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+          spec = svd(ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                     args_dbg_cornerSVD);
+          tmpVal =
+            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+          PrintData(sv);
+          minCornerSV = std::min(minCornerSV, tmpVal);
+          oss << " " << tmpVal;
+
+          diag_minCornerSV.push_back(minCornerSV);
+          std::cout << "MinVals: " << oss.str() << std::endl;
+
+          break;
+        }
       }
+      std::cout << std::endl;
+    }
 
-      if (envI == arg_maxEnvIter) {
-        expValEnvConv = true;
-        std::cout << " MAX ENV iterations REACHED ";
-      }
-      e_prev = e_curr;
-
-      // Perform loop termination
-      if (expValEnvConv) {
-        diag_ctmIter.push_back(envI);
-
-        std::ostringstream oss;
-        oss << std::scientific;
-
-        // Compute spectra of Corner matrices
-        std::cout << std::endl;
-        double tmpVal;
-        double minCornerSV = 1.0e+16;
-        Args args_dbg_cornerSVD = {"Truncate", false};
-        std::cout << "Spectra: " << std::endl;
-
-        ITensor tL(ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]).inds().front()),
-          sv, tR;
-        auto spec = svd(ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv,
-                        tR, args_dbg_cornerSVD);
-        tmpVal =
-          sv.real(sv.inds().front()(auxEnvDim), sv.inds().back()(auxEnvDim));
-        PrintData(sv);
-        minCornerSV = std::min(minCornerSV, tmpVal);
-        oss << tmpVal;
-
-        tL =
-          ITensor(ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-        spec = svd(ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                   args_dbg_cornerSVD);
-        tmpVal =
-          sv.real(sv.inds().front()(auxEnvDim), sv.inds().back()(auxEnvDim));
-        PrintData(sv);
-        minCornerSV = std::min(minCornerSV, tmpVal);
-        oss << " " << tmpVal;
-
-        tL =
-          ITensor(ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-        spec = svd(ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                   args_dbg_cornerSVD);
-        tmpVal =
-          sv.real(sv.inds().front()(auxEnvDim), sv.inds().back()(auxEnvDim));
-        PrintData(sv);
-        minCornerSV = std::min(minCornerSV, tmpVal);
-        oss << " " << tmpVal;
-
-        tL =
-          ITensor(ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-        spec = svd(ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                   args_dbg_cornerSVD);
-        tmpVal =
-          sv.real(sv.inds().front()(auxEnvDim), sv.inds().back()(auxEnvDim));
-        PrintData(sv);
-        minCornerSV = std::min(minCornerSV, tmpVal);
-        oss << " " << tmpVal;
-
-        diag_minCornerSV.push_back(minCornerSV);
-        std::cout << "MinVals: " << oss.str() << std::endl;
-
-        break;
-      }
+    if (rung + 1 < nRungs) {
+      // observables of intermediate x, labelled by x
+      auto metaInf = Args("lineNo", ctmEnv.x);
+      ptr_model->computeAndWriteObservables(ev, out_file_energy, metaInf);
+      if (!arg_outEnvFile.empty())
+        ctmEnv.writeEnv(arg_outEnvFile + ".x" + std::to_string(ctmEnv.x));
     }
-    std::cout << std::endl;
   }
+  if (!arg_outEnvFile.empty())
+    ctmEnv.writeEnv(arg_outEnvFile);
   // ***** CTMRG DONE **************************************
   std::cout << "Timings(CTMRG) :"
             << "Projectors "
@@ -286,10 +434,14 @@ int main(int argc, char* argv[]) {
             << "N/A" << std::endl;
   std::cout << "[mSec]: " << accT[8] << " " << accT[9] << " " << accT[10] << " "
             << accT[11] << std::endl;
+  std::cout << "Projectors computed: " << ctmEnv.isoComputed
+            << " skipped: " << ctmEnv.isoSkipped << std::endl;
+  if (arg_andersonDepth > 0)
+    std::cout << "Anderson restarts: " << ctmEnv.anderson.restarts
+              << std::endl;
 
   // Compute final observables
-  ptr_model->setObservablesHeader(out_file_energy);
-  auto metaInf = Args("lineNo", 0);
+  auto metaInf = Args("lineNo", chiLadder.empty() ? 0 : ctmEnv.x);
   t_begin_int = std::chrono::steady_clock::now();
   ptr_model->computeAndWriteObservables(ev, out_file_energy, metaInf);
   t_end_int = std::chrono::steady_clock::now();
@@ -308,11 +460,9 @@ int main(int argc, char* argv[]) {
               << std::endl;
   }
 
-#ifdef PEPS_WITH_ARPACK
   std::cout << "Transfer matrix spectrum analysis: " << std::endl;
   analyzeTransferMatrix(ev, Vertex(0, 0), CtmEnv::DIRECTION::RIGHT, 5);
   analyzeTransferMatrix(ev, Vertex(0, 0), CtmEnv::DIRECTION::DOWN, 5);
-#endif
 
   // FINISHED
   std::cout << "FINISHED" << std::endl;
@@ -6,7 +6,7 @@
 #include "pi-peps/ctm-cluster-io.h"
 #include "pi-peps/ctm-env.h"
 #include "pi-peps/engine-factory.h"
-#include "pi-peps/linalg/linsyssolvers-lapack.h"
+#include "pi-peps/linsyssolver-factory.h"
 #include "pi-peps/model-factory.h"
 #include "pi-peps/mpo.h"
 #include "pi-peps/svdsolver-factory.h"
@@ -78,6 +78,10 @@ int main(int argc, char* argv[]) {
   double pseudoInvCutoffInsert =
     json_als_params.value("pseudoInvCutoffInsert", 0.0);
 
+  // iterative (cg, minres) solver params
+  double linsysTol = json_als_params.value("linsysTol", 1.0e-10);
+  int linsysMaxIter = json_als_params.value("linsysMaxIter", 500);
+
   // legacy
   // double pseudoInvMaxLogGap = jsonCls["pseudoInvMaxLogGap"].get<double>();
   bool dynamicEps = jsonCls.value("dynamicEps", false);
@@ -105,16 +109,32 @@ int main(int argc, char* argv[]) {
     toNORMALIZATION(json_ctmrg_params["normType"].get<std::string>()));
   std::string env_SVD_METHOD(
     json_ctmrg_params["env_SVD_METHOD"].get<std::string>());
+  // reduced-accuracy CTM pays off only for iterative SVD solvers
+  if (json_ctmrg_params.value("lowPrecisionSwitch", -1.0) > 0.0 &&
+      !supportsLowPrecision(env_SVD_METHOD))
+    throw std::runtime_error(
+      "lowPrecisionSwitch > 0 requires an iterative env_SVD_METHOD "
+      "(warmstart, rsvd, rsvd-lapack, lanczos or arpack), got " +
+      env_SVD_METHOD);
   auto rsvd_power = json_ctmrg_params.value("rsvd_power", 2);
   auto rsvd_reortho = json_ctmrg_params.value("rsvd_reortho", 1);
   auto rsvd_oversampling = json_ctmrg_params.value("rsvd_oversampling", 10);
+  bool arg_ctmSweep = json_ctmrg_params.value("ctmSweep", false);
   int arg_maxEnvIter = json_ctmrg_params["maxEnvIter"].get<int>();
   int arg_maxInitEnvIter = json_ctmrg_params["initMaxEnvIter"].get<int>();
   int arg_obsMaxIter =
     json_ctmrg_params.value("obsMaxIter", arg_maxInitEnvIter);
   double arg_envEps = json_ctmrg_params["envEpsilon"].get<double>();
+  // convergence by spectral distance of corners, disabled for specEps <= 0,
+  // and frequency of (expensive) convergence check by boundary variance
+  double arg_specEps = json_ctmrg_params.value("specEpsilon", -1.0);
+  int arg_varianceCheckFreq =
+    std::max(1, json_ctmrg_params.value("varianceCheckFreq", 1));
   bool arg_reinitEnv = json_ctmrg_params["reinitEnv"].get<bool>();
   bool arg_reinitObsEnv = json_ctmrg_params.value("reinitObsEnv", false);
+  // keep the environment of the best state in a binary checkpoint, from
+  // which it is restored when reverting to that state
+  bool arg_checkpointEnv = json_ctmrg_params.value("checkpointEnv", false);
   bool arg_envDbg = json_ctmrg_params["dbg"].get<bool>();
   int arg_envDbgLvl = json_ctmrg_params["dbgLvl"].get<int>();
   // end reading CTMRG parameters
@@ -179,15 +199,14 @@ int main(int argc, char* argv[]) {
   auto pSvdSolver = sf.create(env_SVD_METHOD);
 
   // ***** Select LinSys solver to use **************************************
+  LinSysSolverFactory lsf = LinSysSolverFactory();
   std::unique_ptr<LinSysSolver> pLinSysSolver;
-  if (linsolver == "cholesky") {
-    pLinSysSolver = std::unique_ptr<CholeskySolver>(new CholeskySolver());
-  } else if (linsolver == "pseudoinverse") {
-    pLinSysSolver = std::unique_ptr<PseudoInvSolver>(new PseudoInvSolver());
-  } else {
+  try {
+    pLinSysSolver = lsf.create(linsolver);
+  } catch (std::runtime_error const&) {
     std::cout << "WARNING: Unsupported LinSysSolver specified. Using default"
               << std::endl;
-    pLinSysSolver = std::unique_ptr<PseudoInvSolver>(new PseudoInvSolver());
+    pLinSysSolver = lsf.create("pseudoinverse");
   }
 
   // INITIALIZE ENVIRONMENT
@@ -206,7 +225,14 @@ int main(int argc, char* argv[]) {
       env_args.add(key, (double)val);
   }
 
-  CtmEnv ctmEnv("default", auxEnvDim, *p_cls, *pSvdSolver, env_args);
+  // choices of auto-tuned SVD solver persist across runs
+  if (!env_args.defined("auto_svd_cache"))
+    env_args.add("auto_svd_cache", std::string("svd-autotune.json"));
+
+  // adaptive environment dimension, growing from auxEnvDimInit to auxEnvDim
+  int arg_auxEnvDimInit = json_ctmrg_params.value("auxEnvDimInit", auxEnvDim);
+  env_args.add("chiMax", auxEnvDim);
+  CtmEnv ctmEnv("default", arg_auxEnvDimInit, *p_cls, *pSvdSolver, env_args);
 
   // INITIALIZE EXPECTATION VALUE BUILDER
   EVBuilder ev("default", *p_cls, ctmEnv);
@@ -269,6 +295,11 @@ int main(int argc, char* argv[]) {
     pseudoInvCutoff,
     "pseudoInvCutoffInsert",
     pseudoInvCutoffInsert,
+
+    "linsysTol",
+    linsysTol,
+    "linsysMaxIter",
+    linsysMaxIter,
   };
   // Diagnostic data
   std::vector<std::string> diag_log;
@@ -332,40 +363,65 @@ int main(int argc, char* argv[]) {
 
   auto computeEnvironment = [&ctmEnv, &ev, &iso_type, &arg_envEps,
                              &arg_initEnvType, &envIsComplex, &arg_envDbg,
-                             &arg_envDbgLvl,
+                             &arg_envDbgLvl, &arg_ctmSweep, &arg_specEps,
+                             &arg_varianceCheckFreq,
                              &get_s](int maxIter, bool reinitEnv) {
     time_point t_begin_int, t_end_int;
     std::vector<double> accT(12, 0.0);
     std::vector<double> e_curr(4, 0.0), e_prev(4, 0.0);
     bool expValEnvConv = false;
 
+    // variances of the boundaries along both directions of two sites
+    auto boundaryVariances = [&ev]() {
+      std::vector<double> e(4);
+      e[0] = analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::RIGHT);
+      e[1] = analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DOWN);
+      e[2] = analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::RIGHT);
+      e[3] = analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DOWN);
+      return e;
+    };
+
     Args diagData_ctm = Args::global();
 
     if (reinitEnv)
       ctmEnv.init(arg_initEnvType, envIsComplex, arg_envDbg);
+    CtmEnv::CtmSpec specPrev;
 
     for (int envI = 1; envI <= maxIter; envI++) {
       t_begin_int = std::chrono::steady_clock::now();
 
-      ctmEnv.move_unidirectional(CtmEnv::DIRECTION::LEFT, iso_type, accT);
-      ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
-      ctmEnv.move_unidirectional(CtmEnv::DIRECTION::RIGHT, iso_type, accT);
-      ctmEnv.move_unidirectional(CtmEnv::DIRECTION::DOWN, iso_type, accT);
+      if (arg_ctmSweep) {
+        ctmEnv.sweep(iso_type, accT);
+      } else {
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::LEFT, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::UP, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::RIGHT, iso_type, accT);
+        ctmEnv.move_unidirectional(CtmEnv::DIRECTION::DOWN, iso_type, accT);
+      }
+      // the residual compares environments of consecutive steps, thus it
+      // is meaningful only if the gauge of the projectors is fixed
+      double envRes = -1.0;
+      if (ctmEnv.andersonDepth > 0 || ctmEnv.isoFixGauge)
+        envRes = ctmEnv.extrapolate();
 
       t_end_int = std::chrono::steady_clock::now();
       std::cout << "CTM STEP " << envI
                 << " T: " << get_s(t_begin_int, t_end_int) << " [sec] ";
-
-      if (envI % 1 == 0) {
+      if (envRes >= 0.0 && ctmEnv.isoFixGauge)
+        std::cout << "Res: " << envRes << " ";
+
+      double dSpec = ctmEnv.specDist(ctmEnv.spec, specPrev);
+      specPrev = ctmEnv.spec;
+      // not measured if projectors were reused
+      if (dSpec >= 0.0)
+        std::cout << "dSpec: " << dSpec << " ";
+      if (ctmEnv.switchPrecision(dSpec))
+        std::cout << "PREC -> double ";
+
+      bool const varianceChecked = (envI % arg_varianceCheckFreq == 0);
+      if (varianceChecked) {
         t_begin_int = std::chrono::steady_clock::now();
-        e_curr[0] =
-          analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::RIGHT);
-        e_curr[1] =
-          analyzeBoundaryVariance(ev, Vertex(0, 0), CtmEnv::DIRECTION::DOWN);
-        e_curr[2] =
-          analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::RIGHT);
-        e_curr[3] =
-          analyzeBoundaryVariance(ev, Vertex(1, 1), CtmEnv::DIRECTION::DOWN);
+        e_curr = boundaryVariances();
         t_end_int = std::chrono::steady_clock::now();
 
         std::cout << " || Var(boundary) in T: " << get_s(t_begin_int, t_end_int)
@@ -379,83 +435,109 @@ int main(int argc, char* argv[]) {
           std::cout << "INIT ENV CONVERGED" << std::endl;
           expValEnvConv = true;
         }
-
-        if (envI == maxIter) {
-          std::cout << " MAX ENV iterations REACHED ";
-          expValEnvConv = true;
-        }
         e_prev = e_curr;
+      } else {
+        std::cout << std::endl;
+      }
 
-        if (expValEnvConv) {
-          // maximal value of transfer-op variance
-          std::vector<double>::iterator result =
-            std::max_element(std::begin(e_curr), std::end(e_curr));
-          auto max_boundaryVar = *result;
+      if (arg_specEps > 0.0 && dSpec >= 0.0 && dSpec < arg_specEps) {
+        std::cout << "SPEC CONVERGED" << std::endl;
+        expValEnvConv = true;
+      }
 
-          std::ostringstream oss;
-          oss << std::scientific;
+      if (envI == maxIter) {
+        std::cout << " MAX ENV iterations REACHED ";
+        expValEnvConv = true;
+      }
 
-          // Compute spectra of Corner matrices
-          std::cout << std::endl;
-          double tmpVal;
-          double max_tailCornerSV = 0.0;
-          Args args_dbg_cornerSVD = {"Truncate", false};
-          std::cout << "Spectra: " << std::endl;
-
-          ITensor tL(
-            ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]).inds().front()),
-            sv, tR;
-          auto spec = svd(ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv,
-                          tR, args_dbg_cornerSVD);
-          tmpVal =
-            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
-          if (arg_envDbg)
-            PrintData(sv);
-          max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
-          oss << tmpVal;
-
-          tL = ITensor(
-            ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-          spec = svd(ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                     args_dbg_cornerSVD);
-          tmpVal =
-            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
-          if (arg_envDbg)
-            PrintData(sv);
-          max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
-          oss << " " << tmpVal;
-
-          tL = ITensor(
-            ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-          spec = svd(ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                     args_dbg_cornerSVD);
-          tmpVal =
-            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
-          if (arg_envDbg)
-            PrintData(sv);
-          max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
-          oss << " " << tmpVal;
-
-          tL = ITensor(
-            ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
-          spec = svd(ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
-                     args_dbg_cornerSVD);
-          tmpVal =
-            sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
-          if (arg_envDbg)
-            PrintData(sv);
-          max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
-          oss << " " << tmpVal;
-
-          std::cout << "MinVals: " << oss.str() << std::endl;
-
-          // record diagnostic data
-          diagData_ctm =
-            Args("ctmI", envI, "max_tailCornerSV", max_tailCornerSV,
-                 "maxBoundaryVariance", max_boundaryVar);
+      // converged with reduced accuracy. Continue in double precision
+      if (expValEnvConv && envI < maxIter && ctmEnv.switchPrecision(0.0)) {
+        expValEnvConv = false;
+        std::cout << "PREC -> double" << std::endl;
+      }
 
-          break;
-        }
+      // converged for current x. Continue with larger x, if required
+      if (expValEnvConv && envI < maxIter && ctmEnv.adaptChi()) {
+        expValEnvConv = false;
+        std::cout << "x -> " << ctmEnv.x << std::endl;
+      }
+
+      if (expValEnvConv) {
+        // loop ended by specEps or maxIter between two variance checks,
+        // e_curr would be those of an earlier environment
+        if (!varianceChecked)
+          e_curr = boundaryVariances();
+
+        // maximal value of transfer-op variance
+        std::vector<double>::iterator result =
+          std::max_element(std::begin(e_curr), std::end(e_curr));
+        auto max_boundaryVar = *result;
+
+        std::ostringstream oss;
+        oss << std::scientific;
+
+        // Compute spectra of Corner matrices
+        std::cout << std::endl;
+        double tmpVal;
+        double max_tailCornerSV = 0.0;
+        Args args_dbg_cornerSVD = {"Truncate", false};
+        std::cout << "Spectra: " << std::endl;
+
+        ITensor tL(
+          ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]).inds().front()),
+          sv, tR;
+        auto spec = svd(ctmEnv.C_LU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv,
+                        tR, args_dbg_cornerSVD);
+        tmpVal =
+          sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+        if (arg_envDbg)
+          PrintData(sv);
+        max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
+        oss << tmpVal;
+
+        tL = ITensor(
+          ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+        spec = svd(ctmEnv.C_RU.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                   args_dbg_cornerSVD);
+        tmpVal =
+          sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+        if (arg_envDbg)
+          PrintData(sv);
+        max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
+        oss << " " << tmpVal;
+
+        tL = ITensor(
+          ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+        spec = svd(ctmEnv.C_RD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                   args_dbg_cornerSVD);
+        tmpVal =
+          sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+        if (arg_envDbg)
+          PrintData(sv);
+        max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
+        oss << " " << tmpVal;
+
+        tL = ITensor(
+          ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]).inds().front());
+        spec = svd(ctmEnv.C_LD.at(ctmEnv.p_cluster->siteIds[0]), tL, sv, tR,
+                   args_dbg_cornerSVD);
+        tmpVal =
+          sv.real(sv.inds().front()(ctmEnv.x), sv.inds().back()(ctmEnv.x));
+        if (arg_envDbg)
+          PrintData(sv);
+        max_tailCornerSV = std::max(max_tailCornerSV, tmpVal);
+        oss << " " << tmpVal;
+
+        std::cout << "MinVals: " << oss.str() << std::endl;
+        std::cout << "Projectors computed: " << ctmEnv.isoComputed
+                  << " skipped: " << ctmEnv.isoSkipped << std::endl;
+
+        // record diagnostic data
+        diagData_ctm =
+          Args("ctmI", envI, "max_tailCornerSV", max_tailCornerSV,
+               "maxBoundaryVariance", max_boundaryVar);
+
+        break;
       }
     }
 
@@ -609,6 +691,8 @@ int main(int argc, char* argv[]) {
         best_energy = current_energy;
         p_cls->metaInfo = "BestEnergy(FUStep=" + std::to_string(fuI) + ")";
         writeCluster(outClusterBestFile, *p_cls);
+        if (arg_checkpointEnv)
+          ctmEnv.writeEnv(outClusterBestFile + ".env");
         past_tensors = p_cls->sites;
       }
       // check if current energy > previous energy
@@ -620,7 +704,13 @@ int main(int argc, char* argv[]) {
         // TODO revert to previous tensors and recompute the environment
         oss << " Reverting to previous tensors";
         p_cls->sites = past_tensors;
-        computeEnvironment(arg_maxInitEnvIter, true);
+        p_cls->siteVersion++;
+        if (arg_checkpointEnv) {
+          ctmEnv.initFromFile(outClusterBestFile + ".env");
+          computeEnvironment(arg_maxInitEnvIter, false);
+        } else {
+          computeEnvironment(arg_maxInitEnvIter, true);
+        }
         // decrease time-step
         auto current_dt = json_model_params["tau"].get<double>();
         json_model_params["tau"] = current_dt * arg_dtFraction;
@@ -517,6 +517,7 @@ int main(int argc, char* argv[]) {
         // TODO revert to previous tensors and recompute the environment
         oss << " Reverting to previous tensors";
         p_cls->sites = past_tensors;
+        p_cls->siteVersion++;
         p_cls->weights = past_weights;
         // decrease time-step
         auto current_dt = json_model_params["tau"].get<double>();
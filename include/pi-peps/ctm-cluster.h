@@ -121,6 +121,11 @@ struct Cluster {
 
   bool weights_absorbed = false;
 
+  // version stamp of on-site tensors. Has to be incremented whenever
+  // sites are modified, such that the cached double-layer tensors held
+  // by CtmEnv are rebuilt
+  long siteVersion = 0;
+
   Cluster() {}
 
   Cluster(int lX_, int lY_)
@@ -156,6 +161,11 @@ struct Cluster {
 
   void normalize(std::string norm_type = "BLE");
 
+  // replace every on-site tensor by its average over the point group C4v
+  // of square lattice (rotations by multiples of pi/2 and reflections)
+  // acting on its auxiliary indices. Requires equal auxiliary dimensions
+  void symmetrizeC4v();
+
   /** make sure the right dtor is called */
   virtual ~Cluster() = default;
 };
@@ -9,6 +9,8 @@
 #include "pi-peps/ctm-cluster-io.h"
 #include "pi-peps/ctm-cluster.h"
 #include "pi-peps/linalg/itensor-svd-solvers.h"
+#include "pi-peps/site-map.h"
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <iostream>
@@ -48,12 +50,164 @@ class CtmEnv {
 
   typedef enum NORMALIZATION { NORM_BLE, NORM_PTN } normalization_type;
 
-  // Holding the current spectrum of singular values of C_*
+  // per-site tensors addressed by integer handles (position of the site
+  // within Cluster::siteIds) or, through a compatibility view, by site id
+  typedef SiteMap<itensor::ITensor> SiteTensorMap;
+  typedef SiteMap<itensor::Index> SiteIndexMap;
+
+  // Holding the spectra of singular values of the (enlarged) corners,
+  // as obtained during the construction of projectors. Indexed by
+  // [direction][site handle], each normalized by its largest element
   struct CtmSpec {
-    std::vector<std::vector<double>> spec_clu;
-    std::vector<std::vector<double>> spec_cru;
-    std::vector<std::vector<double>> spec_crd;
-    std::vector<std::vector<double>> spec_cld;
+    std::vector<std::vector<std::vector<double>>> sv =
+      std::vector<std::vector<std::vector<double>>>(4);
+    // the last move in a direction reused its projectors (see
+    // isoReuseTol), hence its spectra were not measured and sv holds
+    // those of an earlier move
+    std::array<bool, 4> reused = {{false, false, false, false}};
+  };
+
+  // Index plumbing of the projectors of a single site
+  struct IsoPlan {
+    std::string id;
+    int h;
+    Vertex v, v_shift;
+    // combiners of inner indices of halves R and Rt. cmb_p_inner_r yields
+    // the combined index of cmb_pt_inner, such that R and Rt contract
+    // without relabelling
+    itensor::ITensor cmb_p_inner, cmb_p_inner_r, cmb_pt_inner;
+    // combiners of the edges along which the corners of halves H and Ht
+    // are joined by build_halves_V2 (ISOMETRY_T4)
+    std::array<itensor::ITensor, 4> cmb_halves;
+    // (empty) tensors carrying the indices of U for ISOMETRY_T3 and T4
+    itensor::ITensor U_T3, U_T4;
+    // random rank-1 tensors over the indices of U_T3 and U_T4. The sign
+    // of each singular vector is fixed by its overlap with them
+    itensor::ITensor gauge_T3, gauge_T4;
+    itensor::Index ip, ipt;
+  };
+
+  // Projectors of a single site, computed independently of other sites
+  // by compute_Isometries* and merged into the maps P, Pt afterwards
+  struct IsoResult {
+    itensor::ITensor P, Pt;
+    // left singular vectors of previous and current iteration, used
+    // by solvers supporting warm start
+    itensor::ITensor U0, U;
+    double max_sv = 0.0;
+    // singular values normalized by max_sv and discarded weight
+    std::vector<double> sv;
+    double truncErr = 0.0;
+    // timings: Enlarge, SVD, Contract
+    std::array<double, 3> accT = {{0.0, 0.0, 0.0}};
+  };
+
+  // Index plumbing of the absorption of a single site into new C, T, Ct
+  struct AbsorbPlan {
+    std::string id, id_shift, id_shift_f, id_shift_b;
+    int h, h_shift, h_shift_f, h_shift_b;
+    Vertex v, v_shifted, v_shift_f, v_shift_b;
+    // cmb_site_r and cmb_T1_r yield the combined indices of cmb_T0 and
+    // cmb_Tr respectively
+    itensor::ITensor cmb_T0, cmb_site_r, cmb_T1_r, cmb_Tr;
+    // relabelling of environment indices of T towards P(v_shift_b), Pt(v)
+    itensor::ITensor d_T_b, d_T_f;
+    // relabelling of (ket, bra) site indices for layered contraction
+    std::array<itensor::ITensor, 2> d_site_b, d_site_f;
+    // relabelling of indices of new C, T, Ct to those of environment
+    std::vector<itensor::ITensor> post_C, post_T, post_Ct;
+  };
+
+  // Index plumbing of a CTM move in a given direction. It depends only on
+  // the cluster and the environment indices, hence it is built once and
+  // reused by all moves in that direction (see movePlan)
+  struct CtmMovePlan {
+    Cluster const* cluster = nullptr;
+    DIRECTION opposite_direction;
+
+    // geometry of projectors
+    CORNER corner_i, corner_it;
+    DIRECTION p_direction;
+    Shift iso_shift, iso_shift_oi;
+    int iso_dir0, iso_dir1, p_dir;
+    std::vector<IsoPlan> iso;
+
+    // geometry of absorption
+    Shift shift, p_shift;
+    int dir0, dir1;
+    std::vector<AbsorbPlan> absorb;
+  };
+
+  // A single CTM move in a given direction. The move is split into serial
+  // stages (lookup of the plan, merging of results, commit) and
+  // independent per-site tasks, such that tasks of several moves writing
+  // disjoint environment tensors can be executed within one parallel loop.
+  // New tensors are held in nC, nT, nCt until the move is committed
+  struct CtmMove {
+    DIRECTION direction;
+    ISOMETRY iso_type;
+    // projectors are taken over from the previous move (see isoReuseTol)
+    bool reuseIso = false;
+    CtmMovePlan const* plan = nullptr;
+
+    std::vector<IsoResult> iso;
+    SiteIndexMap ip, ipt;
+    SiteTensorMap P, Pt;
+
+    SiteTensorMap *C, *T, *Ct;
+    SiteTensorMap const *Taux, *Tauxt;
+    // timings of absorption of individual sites: C, T, Ct
+    std::vector<std::array<double, 3>> absorbT;
+    // back buffers, swapped with C, T, Ct once the move is committed
+    SiteTensorMap nC, nT, nCt;
+  };
+
+  // Projectors last applied in a given direction. They are reused as long
+  // as two consecutive computations agree, since then also the gauge of
+  // the environment tensors produced by them stays the same
+  struct IsoReuse {
+    ISOMETRY iso_type;
+    long siteVersion = -1;
+    bool stable = false;
+    int reused = 0;
+    SiteIndexMap ip, ipt;
+    SiteTensorMap P, Pt;
+  };
+
+  // History of Anderson (DIIS) extrapolation of the environment. The
+  // environment is treated as a vector of all its C and T tensors, which
+  // is well defined across iterations only if the gauge of environment
+  // indices is fixed (see isoFixGauge)
+  struct CtmAnderson {
+    // history is discarded once the on-site tensors change
+    long siteVersion = -1;
+    // input x of the current iteration, input and residual of the previous
+    std::vector<itensor::ITensor> x, x_prev, r_prev;
+    // differences of inputs and residuals of consecutive iterations
+    std::vector<std::vector<itensor::ITensor>> dx, dr;
+    double minResidual = -1.0;
+    // relative residual |F(x)-x|/|F(x)| of each iteration
+    std::vector<double> residuals;
+    int restarts = 0;
+  };
+
+  // Boundary MPS of a single edge of single-site cluster, see move_vumps.
+  // Mixed canonical form AL*C = C*AR = AC and left, right fixed points
+  // FL, FR of the channel transfer matrix, with the MPS as ket and its
+  // conjugate as bra
+  //
+  //    a0--AL--a1     FL--a0     a1--FR
+  //        |          |              |
+  //        p          l              r
+  //                   |              |
+  //                   FL--b0     b1--FR
+  //
+  struct VumpsBoundary {
+    itensor::ITensor AL, AR, C, FL, FR;
+    // bond indices of ket (a) and bra (b), and a spare one for relabelling
+    itensor::Index a0, a1, b0, b1, t;
+    // max(|AC - AL*C|, |AC - C*AR|) with |AC| = |C| = 1
+    double err = 1.0;
   };
 
   // ########################################################################
@@ -70,6 +224,57 @@ class CtmEnv {
   int rsvd_power = 2;
   int rsvd_reortho = 1;
   int rsvd_oversampling = 10;
+  // refinement steps and residual tolerance of warm-started SVD
+  int warmstart_iter = 2;
+  double warmstart_tol = 1.0e-6;
+  // file persisting the choices of the auto-tuned SVD solver (see
+  // AutoSvdSolver), no persistence if empty
+  std::string autoSvdCache;
+  // number of threads over which the per-site contractions of a single
+  // CTM move are distributed (requires openMP)
+  int ctmThreads = 1;
+  // absorb on-site tensors into corners and half-row/column tensors layer
+  // by layer (ket, then bra) instead of contracting with the double-layer
+  // tensor. Lowers the leading cost from O(x^3 D^8) to O(x^3 D^6)
+  bool layeredContraction = false;
+  // reuse the projectors of a direction while they change by less than
+  // isoReuseTol (max. relative norm of difference over sites) between two
+  // consecutive computations, for at most isoReuseMax moves in a row.
+  // Disabled for isoReuseTol <= 0
+  double isoReuseTol = 0.0;
+  int isoReuseMax = 4;
+  // adaptive environment dimension. Starting from x, adaptChi grows x by
+  // chiStep up to chiMax, as long as the largest discarded weight of the
+  // projectors of the last moves exceeds chiTruncErr. Disabled for
+  // chiMax <= x
+  int chiMax;
+  int chiStep;
+  double chiTruncErr = 0.0;
+  // relative magnitude of random noise added to the tensors embedded
+  // into a larger x (see growChi)
+  double chiNoise = 0.0;
+  // fix the sign of singular vectors, and hence the gauge of environment
+  // indices, of every projector. Enabled by default with extrapolation
+  bool isoFixGauge = false;
+  // Anderson extrapolation over andersonDepth previous iterations with
+  // mixing parameter andersonMixing. History is discarded whenever the
+  // residual exceeds andersonRestart times the lowest residual seen so
+  // far. Disabled for andersonDepth <= 0
+  int andersonDepth = 0;
+  double andersonMixing = 1.0;
+  double andersonRestart = 10.0;
+  double andersonReg = 1.0e-10;
+  // reduced-accuracy phase of CTM started from INIT_ENV_ctmrg or
+  // INIT_ENV_rnd. While lowPrecision is set, the projectors are computed
+  // to single precision accuracy: the iterative SVD solvers stop at
+  // residual sqrt(eps_float) and the pseudo-inverse cutoff is set by
+  // eps_float. Double precision is restored by switchPrecision once the
+  // convergence metric drops below lowPrecisionSwitch. Disabled for
+  // lowPrecisionSwitch <= 0
+  double lowPrecisionSwitch = -1.0;
+  bool lowPrecision = false;
+  // checkpoint read by init(INIT_ENV_file)
+  std::string envFile;
 
   /*
    * Auxiliary dimension of the environment - dimension
@@ -111,10 +316,18 @@ class CtmEnv {
   std::map<std::pair<int, int>, int> cToS;
 
   // arrays holding half-row/column tensors
-  std::map<std::string, itensor::ITensor> T_U, T_R, T_D, T_L;
+  SiteTensorMap T_U, T_R, T_D, T_L;
 
   // corner tensors
-  std::map<std::string, itensor::ITensor> C_LD, C_LU, C_RU, C_RD;
+  SiteTensorMap C_LD, C_LU, C_RU, C_RD;
+
+  // handle of a site within all of the above (and other site-indexed
+  // containers of the environment)
+  int siteHandle(std::string const& id) const { return C_LU.handle(id); }
+
+  int siteHandle(Vertex const& v) const {
+    return siteHandle(p_cluster->vertexToId(v));
+  }
 
   // aux indices of environment tensors (of auxEnvDim == x)
   // itensor::Index I_U, I_R, I_D, I_L;
@@ -128,18 +341,21 @@ class CtmEnv {
   //
   // mapping to 0->I_U0, 1->I_U1, 2->I_R0, 3->I_R1, 4->I_D1, 5->I_D0,
   //            6->I_L1, 7->I_L0
-  std::map<std::string, std::vector<itensor::Index>>
-    eaux;  // environment aux indices
+  SiteMap<std::vector<itensor::Index>> eaux;  // environment aux indices
 
   // indices labeled by direction of T_* tensors
   //   LEFT, UP, RIGHT, DOWN     id  direction
-  std::vector<std::map<std::string, std::vector<itensor::Index>>> itaux;
+  std::vector<SiteMap<std::vector<itensor::Index>>> itaux;
 
   // direction = enum DIRECTION, dir = site-tensor auxiliary index label
   itensor::Index const& tauxByVertex(int direction,
                                      Vertex const& v,
                                      int dir) const {
-    return itaux[direction].at(p_cluster->vertexToId(v))[dir];
+    return itaux[direction][siteHandle(v)][dir];
+  }
+
+  itensor::Index const& tauxByHandle(int direction, int h, int dir) const {
+    return itaux[direction][h][dir];
   }
 
   std::vector<itensor::Index> envIndPair(std::string const& id0,
@@ -169,13 +385,13 @@ class CtmEnv {
 
   // vector indexes combiners 0 1 2 3 in respect to four directions on
   // lattice L, U, R, D for each site
-  std::map<std::string, std::vector<itensor::ITensor>> CMB;
+  SiteMap<std::vector<itensor::ITensor>> CMB;
   // TODO
   // since combiner cant be contracted with delta we have to
   // keep the map from directions to fused site indices I_XH and I_XV
   // L->0->I_XH, U->1->I_XV, R->2->prime(I_XH), D->3->prime(I_XV)
   std::vector<itensor::Index> fusedSiteI;
-  std::map<std::string, std::vector<itensor::Index>> faux;  // fused index
+  SiteMap<std::vector<itensor::Index>> faux;  // fused index
 
   // itensor::ITensor DContractSiteBraKet(Vertex const& v, int dir) const {
   //     return delta(CMB.at(id)[dir],faux.at(id)[dir]);
@@ -185,9 +401,60 @@ class CtmEnv {
     return itensor::delta(combinedIndex(CMB.at(id)[dir]), faux.at(id)[dir]);
   }
 
-  // simple wrapper around spectra of corner matrices
+  // cache of double-layer on-site tensors X = T * T^dag contracted through
+  // physical index, with AUXLINK indices of bra primed by BRAKET_OFFSET.
+  // The fused variant has the bra-ket pairs of aux-indices combined by CMB.
+  // Cache is rebuilt after updateCluster or whenever Cluster::siteVersion
+  // differs from the version it was built for
+  mutable SiteTensorMap braket, braketFused;
+  mutable long braketVersion = -1;
+
+  itensor::ITensor const& siteBraKet(std::string const& id) const;
+  itensor::ITensor const& siteBraKet(Vertex const& v) const;
+  itensor::ITensor const& siteBraKetFused(std::string const& id) const;
+
+  // rebuild the cache if it is out of date. Not thread-safe, hence it has
+  // to be called before the cache is accessed from parallel regions
+  void refreshBraKet() const;
+
+  // contract t with double-layer tensor of site id. Depending on
+  // layeredContraction either at once or layer by layer
+  void absorbSiteBraKet(itensor::ITensor& t, std::string const& id) const;
+
+  // spectra of corners from the last computation of projectors in each
+  // direction. Kept up to date by the CTM moves at no additional cost
   CtmSpec spec;
 
+  // left singular vectors from the last computation of projectors for
+  // each direction and site, the starting subspace of warm-started SVD
+  mutable std::vector<std::map<std::string, itensor::ITensor>> isoBasis =
+    std::vector<std::map<std::string, itensor::ITensor>>(4);
+
+  // projectors available for reuse in each direction, and the number of
+  // (per-site) projector computations which were skipped or performed
+  std::vector<IsoReuse> isoReuse = std::vector<IsoReuse>(4);
+
+  // plans of CTM moves for each direction, built on first use
+  mutable std::vector<CtmMovePlan> movePlans = std::vector<CtmMovePlan>(4);
+  long isoSkipped = 0;
+  long isoComputed = 0;
+  // largest discarded weight over the projectors of the last move in each
+  // direction, 1 - |S|^2/|R*Rt|^2 for kept singular values S. For
+  // move_vumps, which keeps x fixed, the weight s_min^2/|S|^2 of the
+  // smallest Schmidt value of the boundary
+  std::vector<double> isoTruncErr = std::vector<double>(4, 0.0);
+
+  CtmAnderson anderson;
+
+  // boundary MPS of edges LEFT, UP, RIGHT, DOWN and the fixed points of
+  // corners LU, RU, LD, RD (in their own gauge) of the last move_vumps
+  std::vector<VumpsBoundary> vumps = std::vector<VumpsBoundary>(4);
+  std::vector<itensor::ITensor> vumpsCorners =
+    std::vector<itensor::ITensor>(4);
+  // convergence error (VumpsBoundary::err) of each boundary after the last
+  // move_vumps
+  std::vector<double> vumpsErr = std::vector<double>(4, 1.0);
+
   // ########################################################################
   // member methods of CtmEnv
 
@@ -227,9 +494,15 @@ class CtmEnv {
   // Init environment with random R/C tensors elements depending on isComplex
   void initRndEnv(bool isComplex);
 
-  // Init environment from files with tensors stored in format
-  // specified by IO_ENV_FMT
-  //    void initFromFile(int chi, IO_ENV_FMT ioFmt, std::string TAG);
+  // Init environment from binary checkpoint written by writeEnv. The
+  // cluster must have the same layout (size, site ids, auxiliary
+  // dimensions), x is taken from the file. Files with x above maxX
+  // (chiMax if maxX < 0) are rejected
+  void initFromFile(std::string const& filename, int maxX = -1);
+
+  // Write C, T tensors, environment indices and x, together with
+  // the fingerprint of the cluster into binary checkpoint
+  void writeEnv(std::string const& filename) const;
 
   void initCtmrgEnv(bool dbg = false);
 
@@ -255,6 +528,54 @@ class CtmEnv {
                             ISOMETRY iso_type,
                             std::vector<double>& accT);
 
+  // Single CTM sweep moving in all four directions, in the order L,R,U,D.
+  // Opposite directions are performed simultaneously from the same
+  // environment, their per-site tasks are executed concurrently on
+  // ctmThreads threads. Converges to the same fixed point as the moves
+  // L,U,R,D performed one after another by move_unidirectional
+  void sweep(ISOMETRY iso_type, std::vector<double>& accT);
+
+  // Single step of symmetric CTM for single-site cluster, whose on-site
+  // tensor is invariant under C4v (see Cluster::symmetrizeC4v). Uses one
+  // eigendecomposition of a single enlarged corner instead of the SVDs of
+  // four directional moves. Real on-site tensor and environment only
+  void move_c4v(std::vector<double>& accT);
+
+  // Single step of VUMPS for single-site cluster. Boundary MPS of all four
+  // edges are updated by one iteration of variational uniform MPS and
+  // the corners are obtained as fixed points of their growth with
+  // respect to the new boundaries. Both C and T are then replaced
+  void move_vumps(std::vector<double>& accT);
+
+  // Perform moves writing disjoint sets of environment tensors. All moves
+  // read the environment as it was before the call
+  void performMoves(std::vector<CtmMove>& moves, std::vector<double>& accT);
+
+  // returns the plan of moves in given direction, building it if the
+  // cluster changed. Not thread-safe (creates new indices)
+  CtmMovePlan const& movePlan(DIRECTION direction) const;
+
+  void buildMovePlan(DIRECTION direction, CtmMovePlan& pl) const;
+
+  void prepareAbsorption(CtmMove& m);
+
+  void absorbSite(CtmMove& m, int i) const;
+
+  void postprocessSite(CtmMove& m, int i) const;
+
+  // all C and T tensors of the environment, ordered by site handle
+  std::vector<itensor::ITensor> envTensors() const;
+
+  void setEnvTensors(std::vector<itensor::ITensor> const& ts);
+
+  // To be called after each CTM sweep. Records the residual of the sweep
+  // and, if andersonDepth > 0, replaces the environment by its Anderson
+  // extrapolation. Returns the relative residual, or -1 for the first
+  // call after (re)initialization
+  double extrapolate();
+
+  void resetExtrapolation();
+
   // ########################################################################
   // isometries
 
@@ -272,6 +593,28 @@ class CtmEnv {
                             std::map<std::string, itensor::ITensor>& Pt,
                             std::vector<double>& accT) const;
 
+  // copy projectors of a move into string-keyed maps
+  void isometriesToMaps(CtmMove const& m,
+                        std::map<std::string, itensor::Index>& ip,
+                        std::map<std::string, itensor::Index>& ipt,
+                        std::map<std::string, itensor::ITensor>& P,
+                        std::map<std::string, itensor::ITensor>& Pt) const;
+
+  // take over projectors stored in isoReuse, if they can be reused
+  bool loadIsometries(CtmMove& m);
+
+  // store freshly computed projectors of a move in isoReuse and decide
+  // whether they can be reused by subsequent moves
+  void storeIsometries(CtmMove const& m);
+
+  // compute projectors of all given moves, except those with reuseIso set
+  void computeIsometries(std::vector<CtmMove>& moves,
+                         std::vector<double>& accT) const;
+
+  void prepareIsometries(CtmMove& m) const;
+
+  void computeIsometry(CtmMove const& m, int i, IsoResult& r) const;
+
   // build reduced density matrix of 2x2 cluster with cut(=uncontracted
   // indices) along one of the CTM directions U,R,D or L starting from
   // position (col,row), where starting site is always nearest site in
@@ -284,8 +627,15 @@ class CtmEnv {
   //                                                 4|3
   itensor::ITensor build_corner_V2(CORNER cornerType, Vertex const& v) const;
 
+  // combiners of the edges joining the corners of halves built by
+  // build_halves_V2. Not thread-safe (creates new indices)
+  std::array<itensor::ITensor, 4> build_halves_combiners(
+    DIRECTION direction,
+    Vertex const& v) const;
+
   void build_halves_V2(DIRECTION direction,
                        Vertex const& v,
+                       std::array<itensor::ITensor, 4> const& cmb,
                        itensor::ITensor& H,
                        itensor::ITensor& Ht) const;
 
@@ -316,14 +666,33 @@ class CtmEnv {
   // Print stored SVD spectrum of corner matrices C_*
   // void printSVDspec() const;
 
-  // Compute the spectral dist between stored spectrum
-  // in spec_c* and current spectrum
-  // void specDist(CtmSpec const& s1, CtmSpec const& s2) const;
+  // Compute the spectral distance between two records of spectra, the
+  // largest L2 distance over directions and sites. Infinite if any of
+  // the spectra is missing in one of the records. Returns -1 (no
+  // measurement) if any direction of the current record s1 reused its
+  // projectors
+  double specDist(CtmSpec const& s1, CtmSpec const& s2) const;
 
   // Update original cluster with new one of same type
   void updateCluster(Cluster const& c);
 
-  // CtmSpec getCtmSpec() const;
+  // assign indices of T_* tensors (by direction) from eaux
+  void setTauxIndices();
+
+  // grow x if the discarded weight of the last moves calls for it (see
+  // chiMax). Returns true if x changed
+  bool adaptChi();
+
+  // leave the reduced-accuracy phase if 0 <= dist < lowPrecisionSwitch.
+  // Returns true if the precision changed
+  bool switchPrecision(double dist);
+
+  // pad environment to dimension newX > x. The environment (e.g. converged
+  // at smaller x, or read by initFromFile) is embedded into the larger
+  // index space and perturbed by random noise of relative norm noise
+  void growChi(int newX, double noise = 0.0);
+
+  CtmSpec getCtmSpec() const;
 
   /*
    * Export Full environment of cluster - C's and T's for every
@@ -364,4 +733,15 @@ CtmEnv::ISOMETRY toISOMETRY(std::string const& isoType);
 
 CtmEnv::NORMALIZATION toNORMALIZATION(std::string const& normType);
 
+// true if the SVD solver registered as svdMethod is iterative and hence
+// actually runs faster in the reduced-accuracy phase (see
+// CtmEnv::lowPrecisionSwitch). Dense solvers compute the same full SVD
+// and only the cutoff of the pseudo-inverse would change
+bool supportsLowPrecision(std::string const& svdMethod);
+
+// environment dimensions at which CTM is converged in turn, given the
+// requested increasing rungs and the final x. The ladder always ends at x,
+// which is appended if the last rung is smaller. Rungs above x are rejected
+std::vector<int> makeChiLadder(std::vector<int> const& rungs, int x);
+
 #endif
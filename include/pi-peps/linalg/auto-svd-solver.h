@@ -0,0 +1,84 @@
+#ifndef _PEPS_AUTO_SVD_SOLVER_H
+#define _PEPS_AUTO_SVD_SOLVER_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-svd-solvers.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace itensor {
+
+  // Dispatches each decomposition to the fastest of the candidate
+  // solvers for its shape. Shapes are bucketed by (rows, cols, Maxm), each
+  // rounded up to a power of 2, separately for real and complex matrices.
+  //
+  // The first auto_svd_trials (default 3) decompositions of a bucket run
+  // all candidates and time them. The first candidate is the reference and
+  // its result is returned. A candidate whose leading Maxm singular values
+  // deviate from the reference by more than auto_svd_tol * D_0 (default
+  // 1e-8) in any trial is rejected. Afterwards the bucket is served by the
+  // fastest accurate candidate.
+  //
+  // Choices are persisted in JSON file auto_svd_cache, if given (default
+  // empty, no persistence). The file is read once a decomposition names
+  // it and rewritten, through a temporary file and rename, whenever
+  // a bucket is calibrated.
+  //
+  // The solver can be called concurrently. The table of buckets and the
+  // cache are guarded by a mutex, the decompositions run outside of it
+  struct AutoSvdSolver : SvdSolver {
+    void addCandidate(std::string const& name,
+                      std::unique_ptr<SvdSolver> solver);
+
+    void solve(MatRefc<Real> const& M,
+               MatRef<Real> const& U,
+               VectorRef const& D,
+               MatRef<Real> const& V,
+               Args const& args);
+
+    void solve(MatRefc<Cplx> const& M,
+               MatRef<Cplx> const& U,
+               VectorRef const& D,
+               MatRef<Cplx> const& V,
+               Args const& args);
+
+    // name of the candidate serving the bucket of given shape, empty if
+    // the bucket is not calibrated yet
+    std::string selected(bool cplx, long rows, long cols, long maxm) const;
+
+   private:
+    // (complex, log2 rows, log2 cols, log2 maxm)
+    using Key = std::tuple<bool, int, int, int>;
+
+    struct Bucket {
+      int trials = 0;
+      int choice = -1;
+      std::vector<double> time;
+      std::vector<bool> accurate;
+    };
+
+    template <typename T>
+    void solveImpl(MatRefc<T> const& M,
+                   MatRef<T> const& U,
+                   VectorRef const& D,
+                   MatRef<T> const& V,
+                   Args const& args);
+
+    static Key bucket(bool cplx, long rows, long cols, long maxm);
+
+    void loadCache(std::string const& filename);
+    void saveCache() const;
+
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<SvdSolver>> solvers;
+    std::map<Key, Bucket> table;
+    std::string cacheFile;
+    mutable std::mutex mtx;
+  };
+
+}  // namespace itensor
+
+#endif
@@ -5,6 +5,7 @@
 DISABLE_WARNINGS
 #include "itensor/all.h"
 ENABLE_WARNINGS
+#include <functional>
 
 namespace itensor {
 
@@ -41,6 +42,20 @@ namespace itensor {
       std::cout << "[LinSysSolver::solve<Cplx>] called" << std::endl;
     }
 
+    // Matrix-free variant. A is given only by its action applyA(x) on
+    // tensors with the indices of B. X holds the initial guess on input,
+    // if it carries the indices of B. Supported only if matrixFree()
+    virtual void solveMatFree(
+      std::function<ITensor(ITensor const&)> const& /*applyA*/,
+      ITensor const& /*B*/,
+      ITensor& /*X*/,
+      Args const& /*args*/) const {
+      throw std::runtime_error(
+        "[LinSysSolver::solveMatFree] Matrix-free mode not supported");
+    }
+
+    virtual bool matrixFree() const { return false; }
+
     /** make sure the correct destructor is called */
     virtual ~LinSysSolver() = default;
   };
@@ -50,8 +65,24 @@ namespace itensor {
                        ITensor& B,
                        ITensor& X,
                        Args const& args) const override;
+
+    static std::unique_ptr<PseudoInvSolver> create() {
+      return std::unique_ptr<PseudoInvSolver>(new PseudoInvSolver());
+    }
   };
 
+  // Matrix-free counterpart of linsystem for solvers with matrixFree().
+  // Both applyA(x) and B carry the indices of X raised to prime level dpl
+  // (at least partially), which are mapped back to 0 before solving.
+  // X holds the initial guess on input
+  void linsystemMatFree(
+    std::function<ITensor(ITensor const&)> const& applyA,
+    ITensor B,
+    ITensor& X,
+    int dpl,
+    LinSysSolver const& solver,
+    Args const& args = Args::global());
+
   template <class I>
   void linsystem(ITensorT<I> A,
                  ITensorT<I> B,
@@ -31,6 +31,29 @@ namespace itensor {
       SVDRef(M, U, D, V, thresh);
     }
 
+    // Variant of solve supplied with an initial guess U0 of the leading
+    // left singular vectors (columns of U0). Used only by solvers for which
+    // warmStart() is true, others ignore the guess
+    virtual void solveWithGuess(MatRefc<Real> const& M,
+                                MatRef<Real> const& U,
+                                VectorRef const& D,
+                                MatRef<Real> const& V,
+                                MatRefc<Real> const& /* U0 */,
+                                Args const& args) {
+      solve(M, U, D, V, args);
+    }
+
+    virtual void solveWithGuess(MatRefc<Cplx> const& M,
+                                MatRef<Cplx> const& U,
+                                VectorRef const& D,
+                                MatRef<Cplx> const& V,
+                                MatRefc<Cplx> const& /* U0 */,
+                                Args const& args) {
+      solve(M, U, D, V, args);
+    }
+
+    virtual bool warmStart() const { return false; }
+
     virtual ~SvdSolver() = default;
 
     static std::unique_ptr<SvdSolver> create() {
@@ -46,11 +69,34 @@ namespace itensor {
                SvdSolver& solver,
                Args args = Global::args());
 
+  // svd with an initial guess U0 of left singular vectors, passed to
+  // solvers supporting warm start. U0 has to carry all indices of U and
+  // a single link index, otherwise the guess is ignored
+  template <class Tensor>
+  Spectrum svd(Tensor AA,
+               Tensor& U,
+               Tensor& D,
+               Tensor& V,
+               Tensor const& U0,
+               SvdSolver& solver,
+               Args args = Global::args());
+
+  template <class Tensor>
+  Spectrum svd(Tensor AA,
+               Tensor& U,
+               Tensor& D,
+               Tensor& V,
+               SvdSolver& solver,
+               Args args) {
+    return svd(AA, U, D, V, Tensor(), solver, args);
+  }
+
   template <class Tensor>
   Spectrum svd(Tensor AA,
                Tensor& U,
                Tensor& D,
                Tensor& V,
+               Tensor const& U0,
                SvdSolver& solver,
                Args args) {
     using IndexT = typename Tensor::index_type;
@@ -86,15 +132,27 @@ namespace itensor {
       else
         Rinds.push_back(I);
     }
+    bool useGuess = U0 && U && solver.warmStart() &&
+                    (U0.r() == static_cast<long>(Uinds.size()) + 1);
+    for (auto const& I : Uinds)
+      useGuess = useGuess && hasindex(U0, I);
+
+    // creation of new indices is serialized, as svd might be called
+    // concurrently (see CtmEnv::compute_IsometriesT3)
     Tensor Ucomb, Vcomb;
-    if (!Uinds.empty()) {
-      Ucomb = combiner(std::move(Uinds), {"IndexName", "uc"});
-      AA *= Ucomb;
+#ifdef PEPS_WITH_OPENMP
+#pragma omp critical(itensor_index_gen)
+#endif
+    {
+      if (!Uinds.empty())
+        Ucomb = combiner(std::move(Uinds), {"IndexName", "uc"});
+      if (!Vinds.empty())
+        Vcomb = combiner(std::move(Vinds), {"IndexName", "vc"});
     }
-    if (!Vinds.empty()) {
-      Vcomb = combiner(std::move(Vinds), {"IndexName", "vc"});
+    if (Ucomb)
+      AA *= Ucomb;
+    if (Vcomb)
       AA *= Vcomb;
-    }
 
     if (useOrigM) {
       // Try to determine current m,
@@ -117,7 +175,11 @@ namespace itensor {
     auto ui = commonIndex(AA, Ucomb);
     auto vi = commonIndex(AA, Vcomb);
 
-    auto spec = svdRank2(AA, ui, vi, U, D, V, solver, args);
+    Tensor U0c;
+    if (useGuess && Ucomb)
+      U0c = U0 * Ucomb;
+
+    auto spec = svdRank2(AA, ui, vi, U, D, V, U0c, solver, args);
 
     U = dag(Ucomb) * U;
     V = V * dag(Vcomb);
@@ -132,6 +194,7 @@ namespace itensor {
                     ITensorT<IndexT>& U,
                     ITensorT<IndexT>& D,
                     ITensorT<IndexT>& V,
+                    ITensorT<IndexT> const& U0,
                     SvdSolver& solver,
                     Args args = Args::global());
 
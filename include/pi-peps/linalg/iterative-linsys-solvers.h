@@ -0,0 +1,63 @@
+#ifndef _PEPS_ITERATIVE_LINSYS_SOLVERS_H
+#define _PEPS_ITERATIVE_LINSYS_SOLVERS_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-linsys-solvers.h"
+
+namespace itensor {
+
+  // Iterative solvers of A*X = B for hermitian A, operating directly on
+  // tensors with the indices of B. In matrix-free mode A is accessed only
+  // through its action on X, thus A need not be formed (see
+  // linsystemMatFree). The iteration is started from X, if it carries
+  // the indices of B, and stops once ||B - A*X|| < linsysTol * ||B||
+  // or after linsysMaxIter iterations
+  //
+  // Conjugate gradient. Requires A to be positive definite
+  struct CGSolver : LinSysSolver {
+    void solveMatFree(std::function<ITensor(ITensor const&)> const& applyA,
+                      ITensor const& B,
+                      ITensor& X,
+                      Args const& args) const override;
+
+    void solve(MatRefc<Real> const& A,
+               VecRef<Real> const& B,
+               VecRef<Real> const& X,
+               Args const& args) const override;
+
+    void solve(MatRefc<Cplx> const& A,
+               VecRef<Cplx> const& B,
+               VecRef<Cplx> const& X,
+               Args const& args) const override;
+
+    bool matrixFree() const override { return true; }
+
+    static std::unique_ptr<CGSolver> create();
+  };
+
+  // MINRES of Paige and Saunders. A can be indefinite or (close to)
+  // singular, as is the case for poorly conditioned environments
+  struct MinresSolver : LinSysSolver {
+    void solveMatFree(std::function<ITensor(ITensor const&)> const& applyA,
+                      ITensor const& B,
+                      ITensor& X,
+                      Args const& args) const override;
+
+    void solve(MatRefc<Real> const& A,
+               VecRef<Real> const& B,
+               VecRef<Real> const& X,
+               Args const& args) const override;
+
+    void solve(MatRefc<Cplx> const& A,
+               VecRef<Cplx> const& B,
+               VecRef<Cplx> const& X,
+               Args const& args) const override;
+
+    bool matrixFree() const override { return true; }
+
+    static std::unique_ptr<MinresSolver> create();
+  };
+
+}  // namespace itensor
+
+#endif
@@ -0,0 +1,549 @@
+#ifndef _PEPS_KRYLOV_SOLVERS_H
+#define _PEPS_KRYLOV_SOLVERS_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-svd-solvers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Matrix-free Krylov solvers, requiring neither ARPACK nor any other
+// library beyond LAPACK. Operators are supplied as functors with the same
+// interface as TransferOpVecProd
+//
+//   void operator()(double const* x, double* y)    y <- A x
+//
+// All Krylov bases are kept fully orthogonal (two passes of classical
+// Gram-Schmidt) and both solvers are restarted thickly, i.e. by keeping
+// the subspace spanned by wanted Ritz vectors together with the residual
+// of the factorization
+namespace itensor {
+
+#ifdef LAPACK_REQUIRE_EXTERN
+  extern "C" {
+  void F77NAME(dgeev)(char* jobvl,
+                      char* jobvr,
+                      LAPACK_INT* n,
+                      double* a,
+                      LAPACK_INT* lda,
+                      double* wr,
+                      double* wi,
+                      double* vl,
+                      LAPACK_INT* ldvl,
+                      double* vr,
+                      LAPACK_INT* ldvr,
+                      double* work,
+                      LAPACK_INT* lwork,
+                      LAPACK_INT* info);
+  }  // extern "C"
+#endif
+
+  namespace krylov {
+
+    inline double dot(long N, double const* x, double const* y) {
+      double r = 0.0;
+      for (long i = 0; i < N; i++)
+        r += x[i] * y[i];
+      return r;
+    }
+
+    inline double nrm2(long N, double const* x) {
+      return std::sqrt(dot(N, x, x));
+    }
+
+    inline void scal(long N, double a, double* x) {
+      for (long i = 0; i < N; i++)
+        x[i] *= a;
+    }
+
+    // w <- (1 - B B^T) w, where B holds nb orthonormal columns of length N
+    // (column-major). Projections are accumulated into h, if given
+    inline void orthogonalize(long N,
+                              long nb,
+                              double const* B,
+                              double* w,
+                              double* h) {
+      std::vector<double> c(nb);
+      for (int pass = 0; pass < 2; pass++) {
+        for (long i = 0; i < nb; i++)
+          c[i] = dot(N, B + i * N, w);
+        for (long i = 0; i < nb; i++) {
+          double const* b = B + i * N;
+          for (long r = 0; r < N; r++)
+            w[r] -= c[i] * b[r];
+          if (h)
+            h[i] += c[i];
+        }
+      }
+    }
+
+    // w <- random unit vector orthogonal to the nb columns of B
+    inline void randomOrthogonal(long N,
+                                 long nb,
+                                 double const* B,
+                                 double* w,
+                                 std::mt19937& rng) {
+      std::normal_distribution<double> dist(0.0, 1.0);
+      for (int attempt = 0; attempt < 3; attempt++) {
+        for (long r = 0; r < N; r++)
+          w[r] = dist(rng);
+        orthogonalize(N, nb, B, w, nullptr);
+        auto nw = nrm2(N, w);
+        if (nw > 1.0e-8) {
+          scal(N, 1.0 / nw, w);
+          return;
+        }
+      }
+      throw std::runtime_error(
+        "[krylov::randomOrthogonal] Failed to extend orthonormal basis");
+    }
+
+    // First k columns of B (N x m) <- B Y, with Y m x k (column-major)
+    inline void rotate(long N,
+                       long m,
+                       long k,
+                       std::vector<double>& B,
+                       std::vector<double> const& Y) {
+      std::vector<double> BY(N * k, 0.0);
+      for (long c = 0; c < k; c++)
+        for (long r = 0; r < m; r++) {
+          double y = Y[c * m + r];
+          if (y == 0.0)
+            continue;
+          for (long i = 0; i < N; i++)
+            BY[c * N + i] += y * B[r * N + i];
+        }
+      std::copy(BY.begin(), BY.end(), B.begin());
+    }
+
+    // Eigenvalues wr + i*wi and right eigenvectors of the leading m x m
+    // block of column-major H with leading dimension ldh. Eigenvectors
+    // follow the LAPACK convention: for a complex pair (j, j+1) columns j
+    // and j+1 of vr hold the real and imaginary part of eigenvector j
+    inline void denseEig(long m,
+                         double const* H,
+                         long ldh,
+                         std::vector<double>& wr,
+                         std::vector<double>& wi,
+                         std::vector<double>& vr) {
+      std::vector<double> a(m * m);
+      for (long c = 0; c < m; c++)
+        std::copy(H + c * ldh, H + c * ldh + m, a.data() + c * m);
+      wr.assign(m, 0.0);
+      wi.assign(m, 0.0);
+      vr.assign(m * m, 0.0);
+
+      char jobvl = 'N', jobvr = 'V';
+      LAPACK_INT n = m, lda = m, ldvl = 1, ldvr = m;
+      LAPACK_INT lwork = -1, info = 0;
+      double vl = 0.0, wq = 0.0;
+      F77NAME(dgeev)
+      (&jobvl, &jobvr, &n, a.data(), &lda, wr.data(), wi.data(), &vl, &ldvl,
+       vr.data(), &ldvr, &wq, &lwork, &info);
+      lwork = std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq));
+      std::vector<double> work(lwork);
+      F77NAME(dgeev)
+      (&jobvl, &jobvr, &n, a.data(), &lda, wr.data(), wi.data(), &vl, &ldvl,
+       vr.data(), &ldvr, work.data(), &lwork, &info);
+      if (info != 0)
+        throw std::runtime_error("[krylov::denseEig] dgeev failed with info: " +
+                                 std::to_string(info));
+    }
+
+  }  // namespace krylov
+
+  // Leading (largest magnitude) eigenvalues of a real non-symmetric
+  // operator by the thick-restarted Arnoldi method in the Krylov-Schur
+  // form. After each cycle of ncv steps the factorization
+  //
+  //   A V_m = V_m H_m + beta v_m e_m^T
+  //
+  // is shrunk to the invariant subspace of H_m spanned by the real and
+  // imaginary parts of the wanted Ritz vectors, which leaves the relation
+  // intact with H_k dense instead of Hessenberg
+  template <class T>
+  struct ArnoldiEig {
+    T& mvp;
+
+    explicit ArnoldiEig(T& mmvp) : mvp(mmvp) {}
+
+    // Returns the number of converged eigenvalues among the requested
+    // nev. The eigenvalues are returned in ev sorted by magnitude in
+    // descending order. If rvec, X holds the corresponding eigenvectors
+    // as N x nev column-major matrix
+    int real_nonsymm(int const N,
+                     int const nev,
+                     int const max_ncv,
+                     double tol,
+                     int const maxRestart,
+                     std::vector<std::complex<double>>& ev,
+                     std::vector<std::complex<double>>& X,
+                     bool rvec = false,
+                     bool dbg = false) {
+      if (nev < 1 || nev >= N)
+        throw std::runtime_error(
+          "[ArnoldiEig::real_nonsymm] Invalid number of eigenvalues: " +
+          std::to_string(nev));
+      double const eps = std::numeric_limits<double>::epsilon();
+      if (tol <= 0.0)
+        tol = eps;
+
+      long const ncv = std::min(N, std::max(max_ncv, 2 * nev + 1));
+      long const ldh = ncv + 1;
+      std::vector<double> Vb(N * (ncv + 1), 0.0);
+      std::vector<double> H(ldh * ncv, 0.0);
+      std::vector<double> wr, wi, Y;
+      std::vector<long> order(ncv);
+
+      std::mt19937 rng(1234);
+      krylov::randomOrthogonal(N, 0, Vb.data(), Vb.data(), rng);
+
+      // residual norm of the Ritz pair i (eigenvectors of H are unit)
+      double beta = 0.0;
+      auto residual = [&](long i) {
+        if (wi[i] == 0.0)
+          return beta * std::abs(Y[i * ncv + ncv - 1]);
+        long re = (wi[i] > 0.0) ? i : i - 1;
+        return beta *
+               std::hypot(Y[re * ncv + ncv - 1], Y[(re + 1) * ncv + ncv - 1]);
+      };
+
+      long k = 0;
+      int nconv = 0;
+      for (int restart = 0; restart <= maxRestart; restart++) {
+        // extend the factorization to ncv vectors
+        for (long j = k; j < ncv; j++) {
+          double* w = &Vb[(j + 1) * N];
+          mvp(&Vb[j * N], w);
+          krylov::orthogonalize(N, j + 1, Vb.data(), w, &H[j * ldh]);
+          beta = krylov::nrm2(N, w);
+          double hnorm = krylov::nrm2(j + 1, &H[j * ldh]);
+          if (beta <= eps * hnorm) {
+            // invariant subspace found, continue with a fresh direction
+            beta = 0.0;
+            if (j + 1 < ncv)
+              krylov::randomOrthogonal(N, j + 1, Vb.data(), w, rng);
+          } else {
+            krylov::scal(N, 1.0 / beta, w);
+          }
+          H[j * ldh + j + 1] = beta;
+        }
+
+        krylov::denseEig(ncv, H.data(), ldh, wr, wi, Y);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](long a, long b) {
+          return std::hypot(wr[a], wi[a]) > std::hypot(wr[b], wi[b]);
+        });
+
+        nconv = 0;
+        for (int s = 0; s < nev; s++) {
+          long i = order[s];
+          double lambda = std::hypot(wr[i], wi[i]);
+          if (residual(i) <= tol * std::max(lambda, std::pow(eps, 2.0 / 3.0)))
+            nconv++;
+        }
+
+        if (dbg)
+          std::cout << "[ArnoldiEig::real_nonsymm] restart " << restart
+                    << " converged " << nconv << "/" << nev << " |lambda_0| "
+                    << std::hypot(wr[order[0]], wi[order[0]]) << std::endl;
+
+        if (nconv >= nev || restart == maxRestart)
+          break;
+
+        // Select the invariant subspace of H to keep. Complex conjugate
+        // pairs are never split
+        long keep = std::min(ncv - 1, nev + (ncv - nev) / 2);
+        std::vector<double> Z;
+        std::vector<bool> taken(ncv, false);
+        long nz = 0;
+        for (long s = 0; s < ncv && nz < keep; s++) {
+          long i = order[s];
+          if (taken[i])
+            continue;
+          long first = (wi[i] < 0.0) ? i - 1 : i;
+          long cols = (wi[i] == 0.0) ? 1 : 2;
+          if (nz + cols > ncv - 1)
+            break;
+          for (long c = first; c < first + cols; c++) {
+            Z.insert(Z.end(), Y.begin() + c * ncv, Y.begin() + (c + 1) * ncv);
+            taken[c] = true;
+          }
+          nz += cols;
+        }
+
+        // orthonormalize Z dropping linearly dependent columns
+        k = 0;
+        for (long c = 0; c < nz; c++) {
+          double* z = &Z[c * ncv];
+          krylov::orthogonalize(ncv, k, Z.data(), z, nullptr);
+          double nrm = krylov::nrm2(ncv, z);
+          if (nrm < 1.0e-10)
+            continue;
+          krylov::scal(ncv, 1.0 / nrm, z);
+          if (c != k)
+            std::copy(z, z + ncv, &Z[k * ncv]);
+          k++;
+        }
+        Z.resize(k * ncv);
+
+        // H_k = Z^T H_m Z and the coupling to the residual vector
+        std::vector<double> HZ(ncv * k, 0.0);
+        for (long c = 0; c < k; c++)
+          for (long r = 0; r < ncv; r++)
+            for (long l = 0; l < ncv; l++)
+              HZ[c * ncv + l] += H[r * ldh + l] * Z[c * ncv + r];
+        std::fill(H.begin(), H.end(), 0.0);
+        for (long c = 0; c < k; c++) {
+          for (long r = 0; r < k; r++)
+            H[c * ldh + r] = krylov::dot(ncv, &Z[r * ncv], &HZ[c * ncv]);
+          H[c * ldh + k] = beta * Z[c * ncv + ncv - 1];
+        }
+
+        // V_k <- V_m Z and v_k <- v_m
+        krylov::rotate(N, ncv, k, Vb, Z);
+        std::copy(Vb.begin() + ncv * N, Vb.begin() + (ncv + 1) * N,
+                  Vb.begin() + k * N);
+      }
+
+      ev.resize(nev);
+      for (int s = 0; s < nev; s++)
+        ev[s] = std::complex<double>(wr[order[s]], wi[order[s]]);
+
+      if (rvec) {
+        X.assign(N * static_cast<long>(nev), 0.0);
+        for (int s = 0; s < nev; s++) {
+          long i = order[s];
+          long re = (wi[i] < 0.0) ? i - 1 : i;
+          double sign = (wi[i] < 0.0) ? -1.0 : 1.0;
+          for (long r = 0; r < ncv; r++) {
+            std::complex<double> y(Y[re * ncv + r], 0.0);
+            if (wi[i] != 0.0)
+              y.imag(sign * Y[(re + 1) * ncv + r]);
+            for (long n = 0; n < N; n++)
+              X[s * N + n] += y * Vb[r * N + n];
+          }
+        }
+      }
+
+      return nconv;
+    }
+  };
+
+  // Leading singular triplets of a real m x n operator by the
+  // thick-restarted Golub-Kahan-Lanczos bidiagonalization (as in IRLBA of
+  // Baglama and Reichel). The operator is given by two functors
+  //
+  //   av(x, y)     y <- A x      x of length n, y of length m
+  //   atv(y, x)    x <- A^T y
+  //
+  // After each cycle the factorization A P_l = Q_l B_l,
+  // A^T Q_l = P_l B_l^T + beta p_l e_l^T is shrunk to the leading k Ritz
+  // triplets of B_l, with p_l kept as the next starting vector
+  template <class TA, class TAt>
+  struct LanczosSvd {
+    TA& av;
+    TAt& atv;
+
+    LanczosSvd(TA& av_, TAt& atv_) : av(av_), atv(atv_) {}
+
+    // Returns the number of converged triplets among the requested nsv.
+    // On exit S holds singular values in descending order, U and V the
+    // left and right singular vectors as m x nsv and n x nsv column-major
+    // matrices
+    int topk(int const m,
+             int const n,
+             int const nsv,
+             int const max_ncv,
+             double tol,
+             int const maxRestart,
+             std::vector<double>& S,
+             std::vector<double>& U,
+             std::vector<double>& V,
+             bool dbg = false) {
+      int const nmin = std::min(m, n);
+      if (nsv < 1 || nsv > nmin)
+        throw std::runtime_error(
+          "[LanczosSvd::topk] Invalid number of singular values: " +
+          std::to_string(nsv));
+      double const eps = std::numeric_limits<double>::epsilon();
+      if (tol <= 0.0)
+        tol = eps;
+
+      long const l = std::min(nmin, std::max(max_ncv, 2 * nsv + 1));
+      std::vector<double> P(n * (l + 1), 0.0);
+      std::vector<double> Q(m * l, 0.0);
+      std::vector<double> B(l * l, 0.0);
+      Mat<Real> Bm(l, l), Ub(l, l), Vb(l, l);
+      Vector Db(l);
+
+      std::mt19937 rng(1234);
+      krylov::randomOrthogonal(n, 0, P.data(), P.data(), rng);
+
+      double beta = 0.0;
+      double anorm = 0.0;
+      long k = 0;
+      int nconv = 0;
+      for (int restart = 0; restart <= maxRestart; restart++) {
+        for (long j = k; j < l; j++) {
+          double* q = &Q[j * m];
+          av(&P[j * n], q);
+          krylov::orthogonalize(m, j, Q.data(), q, &B[j * l]);
+          double alpha = krylov::nrm2(m, q);
+          anorm = std::max(anorm, alpha);
+          if (alpha <= eps * anorm) {
+            alpha = 0.0;
+            krylov::randomOrthogonal(m, j, Q.data(), q, rng);
+          } else {
+            krylov::scal(m, 1.0 / alpha, q);
+          }
+          B[j * l + j] = alpha;
+
+          double* p = &P[(j + 1) * n];
+          atv(q, p);
+          krylov::orthogonalize(n, j + 1, P.data(), p, nullptr);
+          beta = krylov::nrm2(n, p);
+          anorm = std::max(anorm, beta);
+          if (beta <= eps * anorm) {
+            beta = 0.0;
+            if (j + 1 < l)
+              krylov::randomOrthogonal(n, j + 1, P.data(), p, rng);
+          } else {
+            krylov::scal(n, 1.0 / beta, p);
+          }
+        }
+
+        for (long c = 0; c < l; c++)
+          for (long r = 0; r < l; r++)
+            Bm(r, c) = B[c * l + r];
+        MatRefc<Real> Bref = makeRef(Bm);
+        SVDRef(Bref, makeRef(Ub), makeRef(Db), makeRef(Vb), 1.0E-3);
+
+        nconv = 0;
+        for (int s = 0; s < nsv; s++)
+          if (beta * std::abs(Ub(l - 1, s)) <= tol * Db(0))
+            nconv++;
+
+        if (dbg)
+          std::cout << "[LanczosSvd::topk] restart " << restart << " converged "
+                    << nconv << "/" << nsv << " sigma_0 " << Db(0)
+                    << std::endl;
+
+        if (nconv >= nsv || restart == maxRestart)
+          break;
+
+        // keep leading k Ritz triplets, B_k = diag(sigma). The coupling
+        // B(0:k,k) = beta Ub(l-1,0:k) is recovered by the next projection
+        k = std::min(l - 1, nsv + (l - nsv) / 2);
+        std::vector<double> Yu(l * k), Yv(l * k);
+        for (long c = 0; c < k; c++)
+          for (long r = 0; r < l; r++) {
+            Yu[c * l + r] = Ub(r, c);
+            Yv[c * l + r] = Vb(r, c);
+          }
+        krylov::rotate(m, l, k, Q, Yu);
+        krylov::rotate(n, l, k, P, Yv);
+        std::copy(P.begin() + l * n, P.begin() + (l + 1) * n,
+                  P.begin() + k * n);
+        std::fill(B.begin(), B.end(), 0.0);
+        for (long c = 0; c < k; c++)
+          B[c * l + c] = Db(c);
+      }
+
+      S.resize(nsv);
+      U.assign(m * static_cast<long>(nsv), 0.0);
+      V.assign(n * static_cast<long>(nsv), 0.0);
+      for (long c = 0; c < nsv; c++) {
+        S[c] = Db(c);
+        for (long r = 0; r < l; r++) {
+          double u = Ub(r, c), v = Vb(r, c);
+          for (long i = 0; i < m; i++)
+            U[c * m + i] += u * Q[r * m + i];
+          for (long i = 0; i < n; i++)
+            V[c * n + i] += v * P[r * n + i];
+        }
+      }
+
+      return nconv;
+    }
+  };
+
+  // Truncated SVD by LanczosSvd returning leading Maxm singular triplets,
+  // the rest of U, D, V is set to zero. Complex matrices and requests for
+  // Maxm >= min(m,n)/2 singular values are passed to the default solver
+  struct LanczosSvdSolver : SvdSolver {
+    void solve(MatRefc<Real> const& M,
+               MatRef<Real> const& U,
+               VectorRef const& D,
+               MatRef<Real> const& V,
+               Args const& args) {
+      auto Mr = nrows(M);
+      auto Mc = ncols(M);
+      long nsv = std::min(Mr, Mc);
+      long k = std::min<long>(args.getInt("Maxm", nsv), nsv);
+      if (k < 1 || 2 * k >= nsv || k > ncols(U) || k > ncols(V)) {
+        SvdSolver::solve(M, U, D, V, args);
+        return;
+      }
+
+      auto av = [&M, &Mr, &Mc](double const* x, double* y) {
+        mult(M, makeVecRef(x, Mc), makeVecRef(y, Mr));
+      };
+      auto atv = [&M, &Mr, &Mc](double const* x, double* y) {
+        mult(M, makeVecRef(x, Mr), makeVecRef(y, Mc), true);
+      };
+
+      int ncv = args.getInt("lanczos_svd_ncv", 2 * k + k / 2 + 1);
+      double tol = args.getReal("lanczos_svd_tol", 1.0e-10);
+      int maxRestart = args.getInt("lanczos_svd_maxrestart", 100);
+      bool dbg = args.getBool("svd_dbg", false);
+
+      std::vector<double> s, u, v;
+      LanczosSvd<decltype(av), decltype(atv)> lsvd(av, atv);
+      int nconv = lsvd.topk(Mr, Mc, k, ncv, tol, maxRestart, s, u, v, dbg);
+      if (nconv < k)
+        std::cout << "[LanczosSvdSolver::solve] Converged " << nconv << " of "
+                  << k << " singular triplets" << std::endl;
+
+      for (auto& el : U)
+        el = 0.0;
+      for (auto& el : V)
+        el = 0.0;
+      for (auto& el : D)
+        el = 0.0;
+      for (long c = 0; c < k; c++) {
+        D(c) = s[c];
+        for (long r = 0; r < Mr; r++)
+          U(r, c) = u[c * Mr + r];
+        for (long r = 0; r < Mc; r++)
+          V(r, c) = v[c * Mc + r];
+      }
+#ifdef CHKSVD
+      checksvd(M, U, D, V);
+#endif
+    }
+
+    void solve(MatRefc<Cplx> const& M,
+               MatRef<Cplx> const& U,
+               VectorRef const& D,
+               MatRef<Cplx> const& V,
+               Args const& args) {
+      SvdSolver::solve(M, U, D, V, args);
+    }
+
+    static std::unique_ptr<LanczosSvdSolver> create() {
+      return std::unique_ptr<LanczosSvdSolver>(new LanczosSvdSolver());
+    }
+  };
+
+}  // namespace itensor
+
+#endif
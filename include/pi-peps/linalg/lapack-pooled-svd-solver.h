@@ -0,0 +1,42 @@
+#ifndef _PEPS_LAPACK_POOLED_SVD_SOLVER_H
+#define _PEPS_LAPACK_POOLED_SVD_SOLVER_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-svd-solvers.h"
+
+namespace itensor {
+
+  // Full SVD by LAPACK drivers ?gesdd (divide & conquer), ?gesvd (QR
+  // iteration) or dgejsv (preconditioned Jacobi, real matrices only -
+  // complex ones are passed to zgesvd). Unlike GESDDSolver, the copy of
+  // the input and all LAPACK workspaces are held in thread-local pools
+  // keyed by driver, jobz and shape (m,n). The optimal size of workspace
+  // is queried (lwork = -1) once per shape, such that repeated
+  // decompositions of matrices of the same shape perform no allocation
+  struct LapackSvdSolver : SvdSolver {
+    enum DRIVER { GESDD, GESVD, GEJSV };
+
+    explicit LapackSvdSolver(DRIVER d) : driver(d) {}
+
+    void solve(MatRefc<Real> const& M,
+               MatRef<Real> const& U,
+               VectorRef const& D,
+               MatRef<Real> const& V,
+               Args const& args);
+
+    void solve(MatRefc<Cplx> const& M,
+               MatRef<Cplx> const& U,
+               VectorRef const& D,
+               MatRef<Cplx> const& V,
+               Args const& args);
+
+    static std::unique_ptr<LapackSvdSolver> createGesdd();
+    static std::unique_ptr<LapackSvdSolver> createGesvd();
+    static std::unique_ptr<LapackSvdSolver> createGejsv();
+
+    DRIVER driver;
+  };
+
+}  // namespace itensor
+
+#endif
@@ -68,20 +68,20 @@ namespace itensor {
   //         The columns of X are the corresponding solutions.
   // The matrix B is overwritten by X.
   //
-  LAPACK_INT
+  inline LAPACK_INT
   zgesv_wrapper(
     LAPACK_INT n,     // rank of square matrix A
     LAPACK_INT nrhs,  // number of right hand sides b = matrix n x nrhs
     Cplx const* A,    // matrix A
     Cplx* b);         // matrix b
 
-  LAPACK_INT
+  inline LAPACK_INT
   dgesv_wrapper(LAPACK_INT n,
                 LAPACK_INT nrhs,
                 LAPACK_REAL const* A,
                 LAPACK_REAL* b);
 
-  LAPACK_INT
+  inline LAPACK_INT
   zgesv_wrapper(
     LAPACK_INT n,     // rank of square matrix A
     LAPACK_INT nrhs,  // number of right hand sides b = matrix n x nrhs
@@ -116,7 +116,7 @@ namespace itensor {
     return info;
   }
 
-  LAPACK_INT
+  inline LAPACK_INT
   dgesv_wrapper(
     LAPACK_INT n,          // rank of square matrix A
     LAPACK_INT nrhs,       // number of right hand sides b = matrix n x nrhs
@@ -222,6 +222,10 @@ namespace itensor {
         throw std::runtime_error("CholeskySolver: error info: " +
                                  std::to_string(info));
     }
+
+    static std::unique_ptr<CholeskySolver> create() {
+      return std::unique_ptr<CholeskySolver>(new CholeskySolver());
+    }
   };
 
 }  // namespace itensor
@@ -0,0 +1,39 @@
+#ifndef _PEPS_RSVD_LAPACK_SOLVER_H
+#define _PEPS_RSVD_LAPACK_SOLVER_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-svd-solvers.h"
+
+namespace itensor {
+
+  // Randomized truncated SVD (range finder with power iterations) relying
+  // only on BLAS and LAPACK. For M of size m x n and l = Maxm + oversampling
+  //
+  //   Q = orth(M G)                      G - n x l gaussian
+  //   repeat rsvd_power times:
+  //     Z = M^dag Q,  Q = M Z            (orthonormalized every
+  //                                       rsvd_reortho-th step)
+  //   Q^dag M = Ub D V^dag,  U = Q Ub
+  //
+  // Orthonormalization is done by Householder QR (?geqrf, ?orgqr/?ungqr).
+  // The leading l singular triplets are written into U, D, V, the rest is
+  // set to zero. Falls back to full decomposition if l >= min(m,n)
+  struct RandomizedSvdSolver : SvdSolver {
+    void solve(MatRefc<Real> const& M,
+               MatRef<Real> const& U,
+               VectorRef const& D,
+               MatRef<Real> const& V,
+               Args const& args);
+
+    void solve(MatRefc<Cplx> const& M,
+               MatRef<Cplx> const& U,
+               VectorRef const& D,
+               MatRef<Cplx> const& V,
+               Args const& args);
+
+    static std::unique_ptr<RandomizedSvdSolver> create();
+  };
+
+}  // namespace itensor
+
+#endif
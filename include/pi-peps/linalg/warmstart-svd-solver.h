@@ -0,0 +1,52 @@
+#ifndef _PEPS_WARMSTART_SVD_SOLVER_H
+#define _PEPS_WARMSTART_SVD_SOLVER_H
+
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/itensor-svd-solvers.h"
+
+namespace itensor {
+
+  // Truncated SVD by block subspace iteration started from the supplied
+  // guess of the leading left singular vectors, i.e. the left singular
+  // vectors of the previous CTM iteration. After "warmstart_iter" steps
+  // the Ritz vectors are accepted if the relative residual
+  //
+  //   |M^T U - V D|_F / D(0) < warmstart_tol
+  //
+  // otherwise full decomposition is performed. Without guess the solver
+  // always falls back to the full decomposition
+  struct WarmStartSvdSolver : SvdSolver {
+    void solve(MatRefc<Real> const& M,
+               MatRef<Real> const& U,
+               VectorRef const& D,
+               MatRef<Real> const& V,
+               Args const& args);
+
+    void solve(MatRefc<Cplx> const& M,
+               MatRef<Cplx> const& U,
+               VectorRef const& D,
+               MatRef<Cplx> const& V,
+               Args const& args);
+
+    void solveWithGuess(MatRefc<Real> const& M,
+                        MatRef<Real> const& U,
+                        VectorRef const& D,
+                        MatRef<Real> const& V,
+                        MatRefc<Real> const& U0,
+                        Args const& args);
+
+    void solveWithGuess(MatRefc<Cplx> const& M,
+                        MatRef<Cplx> const& U,
+                        VectorRef const& D,
+                        MatRef<Cplx> const& V,
+                        MatRefc<Cplx> const& U0,
+                        Args const& args);
+
+    bool warmStart() const { return true; }
+
+    static std::unique_ptr<WarmStartSvdSolver> create();
+  };
+
+}  // namespace itensor
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __LINSYSSOLVER_FACTORY_
+#define __LINSYSSOLVER_FACTORY_
+
+#include "pi-peps/config.h"
+#include <functional>
+#include <map>
+#include "pi-peps/linalg/itensor-linsys-solvers.h"
+
+class LinSysSolverFactory {
+ public:
+  using TCreateMethod =
+    std::function<std::unique_ptr<itensor::LinSysSolver>()>;
+
+  LinSysSolverFactory();
+  virtual ~LinSysSolverFactory() = default;
+
+  bool registerSolver(std::string const& name, TCreateMethod funcCreate);
+
+  std::unique_ptr<itensor::LinSysSolver> create(std::string const& name);
+
+ private:
+  std::map<std::string, TCreateMethod> s_methods;
+};
+
+#endif
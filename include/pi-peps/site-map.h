@@ -0,0 +1,96 @@
+#ifndef __SITE_MAP_H_
+#define __SITE_MAP_H_
+
+#include "pi-peps/config.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Container of per-site data stored contiguously and addressed by integer
+ * site handles. Handles are shared between containers of the same layout,
+ * hence containers created from the layout of another one can be swapped
+ * with it. String-keyed access mimics std::map<std::string, T> and
+ * resolves the id to a handle first
+ *
+ */
+template <typename T>
+class SiteMap {
+ public:
+  typedef std::map<std::string, int> Layout;
+
+  SiteMap() : handles(std::make_shared<Layout>()) {}
+
+  // one default constructed element for each id, the handle of id is its
+  // position within ids
+  explicit SiteMap(std::vector<std::string> const& ids)
+    : data(ids.size()) {
+    auto tmp = std::make_shared<Layout>();
+    for (int i = 0; i < static_cast<int>(ids.size()); i++)
+      (*tmp)[ids[i]] = i;
+    handles = tmp;
+  }
+
+  // default constructed elements for all handles of given layout
+  explicit SiteMap(std::shared_ptr<Layout const> const& layout)
+    : handles(layout), data(layout->size()) {}
+
+  std::shared_ptr<Layout const> const& layout() const { return handles; }
+
+  int handle(std::string const& id) const { return handles->at(id); }
+
+  std::size_t count(std::string const& id) const {
+    return handles->count(id);
+  }
+
+  // access by handle
+  T& operator[](int h) { return data[h]; }
+  T const& operator[](int h) const { return data[h]; }
+  T& at(int h) { return data.at(h); }
+  T const& at(int h) const { return data.at(h); }
+
+  // access by id. Throws std::out_of_range if id is not present
+  T& at(std::string const& id) { return data[handle(id)]; }
+  T const& at(std::string const& id) const { return data[handle(id)]; }
+
+  // access by id, inserting a new element (and handle) if id is not present.
+  // The layout of other containers sharing it is not affected
+  T& operator[](std::string const& id) {
+    auto it = handles->find(id);
+    if (it != handles->end())
+      return data[it->second];
+
+    auto tmp = std::make_shared<Layout>(*handles);
+    (*tmp)[id] = static_cast<int>(data.size());
+    handles = tmp;
+    data.emplace_back();
+    return data.back();
+  }
+
+  std::size_t size() const { return data.size(); }
+  bool empty() const { return data.empty(); }
+
+  // reset all elements, keeping the layout
+  void clear() { data.assign(data.size(), T()); }
+
+  // exchange contents (and layouts) in constant time
+  void swap(SiteMap& other) {
+    handles.swap(other.handles);
+    data.swap(other.data);
+  }
+
+  // iteration over elements in the order of handles
+  typename std::vector<T>::iterator begin() { return data.begin(); }
+  typename std::vector<T>::iterator end() { return data.end(); }
+  typename std::vector<T>::const_iterator begin() const {
+    return data.begin();
+  }
+  typename std::vector<T>::const_iterator end() const { return data.end(); }
+
+ private:
+  std::shared_ptr<Layout const> handles;
+  std::vector<T> data;
+};
+
+#endif
@@ -4,9 +4,8 @@
 #include "pi-peps/config.h"
 #include "pi-peps/cluster-ev-builder.h"
 
-#ifdef PEPS_WITH_ARPACK
-
-#  include "pi-peps/linalg/arpack-rcdn.h"
+#include "pi-peps/linalg/arpack-rcdn.h"
+#include "pi-peps/linalg/krylov-solvers.h"
 
 namespace itensor {
 
@@ -22,16 +21,15 @@ namespace itensor {
     void operator()(double const* const x, double* const y, bool DBG = false);
   };
 
-  // ARPACK required
+  // Leading eigenvalues of the transfer matrix by built-in restarted
+  // Arnoldi (alg_type "ARNOLDI") or by ARPACK, if available ("ARPACK")
   void analyzeTransferMatrix(EVBuilder const& ev,
                              Vertex const& v,
                              CtmEnv::DIRECTION dir = CtmEnv::DIRECTION::RIGHT,
                              int num_eigs = 2,
-                             std::string alg_type = "ARPACK");
+                             std::string alg_type = "ARNOLDI");
 }  // namespace itensor
 
-#endif
-
 namespace itensor {
 
   struct TransferOpVecProd_itensor {
@@ -161,9 +161,7 @@ double EVBuilder::eV_1sO_1sENV(MpoNS const& op,
 std::vector<double> EVBuilder::eeCorner_1s_inner(Vertex const& v,
                                                  bool DBG) const {
   auto getSiteBraKet = [this](std::string const& id) {
-    return p_cluster->sites.at(id) *
-           dag(p_cluster->sites.at(id))
-             .prime(AUXLINK, p_cluster->BRAKET_OFFSET);
+    return p_ctmEnv->siteBraKet(id);
   };
 
   auto computeEE = [](ITensor const& t) {
@@ -274,9 +272,7 @@ std::vector<double> EVBuilder::eeCorner_1s_inner(Vertex const& v,
 std::vector<double> EVBuilder::eeCorner_1s_outer(Vertex const& v,
                                                  bool DBG) const {
   auto getSiteBraKet = [this](std::string const& id) {
-    return p_cluster->sites.at(id) *
-           dag(p_cluster->sites.at(id))
-             .prime(AUXLINK, p_cluster->BRAKET_OFFSET);
+    return p_ctmEnv->siteBraKet(id);
   };
 
   auto computeEE = [](ITensor const& t) {
@@ -453,9 +449,7 @@ ITensor EVBuilder::insert2S(bool DBG,
   auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
 
   auto getSiteBraKet = [this, &vToId](Vertex const& v) {
-    return p_cluster->sites.at(vToId(v)) *
-           dag(p_cluster->sites.at(vToId(v)))
-             .prime(AUXLINK, p_cluster->BRAKET_OFFSET);
+    return p_ctmEnv->siteBraKet(vToId(v));
   };
 
   auto applyDeltaEdge = [this](ITensor& t, Vertex const& v, DIRECTION edge,
@@ -975,9 +969,7 @@ double EVBuilder::contract2x2Diag11(std::pair<ITensor, ITensor> const& op,
   auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
 
   auto getSiteBraKet = [this, &vToId](Vertex const& v) {
-    return p_cluster->sites.at(vToId(v)) *
-           dag(p_cluster->sites.at(vToId(v)))
-             .prime(AUXLINK, p_cluster->BRAKET_OFFSET);
+    return p_ctmEnv->siteBraKet(vToId(v));
   };
 
   auto get2dirSiteCombiner = [this](ITensor& cmb, Vertex const& v,
@@ -1174,9 +1166,7 @@ double EVBuilder::contract2x2DiagN11(std::pair<ITensor, ITensor> const& op,
   auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
 
   auto getSiteBraKet = [this, &vToId](Vertex const& v) {
-    return p_cluster->sites.at(vToId(v)) *
-           dag(p_cluster->sites.at(vToId(v)))
-             .prime(AUXLINK, p_cluster->BRAKET_OFFSET);
+    return p_ctmEnv->siteBraKet(vToId(v));
   };
 
   auto readyToContract = [this](ITensor& t, DIRECTION direction,
@@ -0,0 +1,186 @@
+#include "pi-peps/config.h"
+#include "pi-peps/ctm-env.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace itensor;
+
+// Symmetric CTM for a single-site cluster with C4v-symmetric on-site tensor
+// (see Cluster::symmetrizeC4v). All corners and all half-row/column tensors
+// are equal up to relabelling, hence a single step builds one corner and
+// one half-row/column tensor from C_LU, T_L, T_U
+//
+//  C_LU--T_U--I_U1      The enlarged corner M is symmetric under the
+//   |     |             reflection through the diagonal, exchanging
+//  T_L---X----r         (I_L1,d) and (I_U1,r). Hence M = U*D*U^T with
+//   |     |             eigenvectors U. The eigenvectors of x largest
+//  I_L1   d             eigenvalues (in magnitude) define the projector
+//
+//  C' = D restricted to the x leading eigenvalues
+//
+//       I_L0,u--U--ip'
+//        |
+//  T' = T_L*X--r
+//        |
+//       I_L1,d--U--ip
+//
+// Only real tensors are supported. For complex on-site tensor M is
+// complex symmetric, M = M^T, but not hermitian and its decomposition
+// would require Takagi factorization instead of diagHermitian
+//
+void CtmEnv::move_c4v(std::vector<double>& accT) {
+  if (p_cluster->siteIds.size() != 1)
+    throw std::runtime_error("[move_c4v] Cluster with single site required");
+
+  using time_point = std::chrono::high_resolution_clock::time_point;
+  time_point t_begin, t_end, t_iso_begin;
+  auto get_mS = [](time_point ti, time_point tf) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tf - ti)
+             .count() /
+           1000.0;
+  };
+
+  auto normalizeBLE_T = [](ITensor& t) {
+    double max_elem = 0.;
+    auto max_m = [&max_elem](double d) {
+      if (std::abs(d) > max_elem)
+        max_elem = std::abs(d);
+    };
+
+    t.visit(max_m);
+    if (max_elem == 0.0)
+      throw std::runtime_error(
+        "[move_c4v] Half-row/column tensor is zero, environment is "
+        "degenerate");
+    t *= 1.0 / max_elem;
+  };
+
+  auto const& id = p_cluster->siteIds[0];
+  int const h = siteHandle(id);
+  if (isComplex(p_cluster->sites.at(id)) || isComplex(C_LU[h]) ||
+      isComplex(T_L[h]) || isComplex(T_U[h]))
+    throw std::runtime_error(
+      "[move_c4v] Complex on-site tensor or environment is not supported");
+  auto const ea = eaux[h];
+  auto braKet = [this, &id](int dir) {
+    return p_cluster->AIBraKetPair(id, dir);
+  };
+
+  // enlarged corner
+  t_begin = std::chrono::high_resolution_clock::now();
+  ITensor M = C_LU[h] * T_L[h];
+  M *= T_U[h];
+  absorbSiteBraKet(M, id);
+
+  // fuse rows (I_L1,d) and columns (I_U1,r) into indices i, i'
+  auto cmbRow = combiner(ea[6], braKet(3)[0], braKet(3)[1]);
+  auto cmbCol = combiner(ea[1], braKet(2)[0], braKet(2)[1]);
+  auto ir = combinedIndex(cmbRow);
+  M *= cmbRow;
+  M *= reindex(cmbCol, combinedIndex(cmbCol), prime(ir));
+  M = 0.5 * (M + swapPrime(M, 0, 1));
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[4] += get_mS(t_begin, t_end);
+
+  // eigendecomposition and projector
+  t_iso_begin = std::chrono::high_resolution_clock::now();
+  ITensor U, D;
+  diagHermitian(M, U, D, {"Truncate", false});
+  auto l = commonIndex(U, D);
+  std::vector<double> ev(l.m());
+  for (int k = 1; k <= l.m(); k++)
+    ev[k - 1] = D.real(D.inds().front()(k), D.inds().back()(k));
+
+  std::vector<int> order(ev.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&ev](int a, int b) {
+    return std::abs(ev[a]) > std::abs(ev[b]);
+  });
+
+  int const nx = std::min(x, static_cast<int>(ev.size()));
+  auto ip = Index(id + "-c4v", x);
+  ITensor sel(l, ip);
+  std::vector<double> cdiag(x, 0.0);
+  double w_total = 0.0;
+  double w_kept = 0.0;
+  for (auto const& e : ev)
+    w_total += e * e;
+  for (int k = 0; k < nx; k++) {
+    sel.set(l(order[k] + 1), ip(k + 1), 1.0);
+    cdiag[k] = ev[order[k]];
+    w_kept += cdiag[k] * cdiag[k];
+  }
+  double c_max = 0.0;
+  for (auto const& c : cdiag)
+    c_max = std::max(c_max, std::abs(c));
+  if (c_max == 0.0)
+    throw std::runtime_error(
+      "[move_c4v] Enlarged corner is zero, environment is degenerate");
+  auto P = U * sel;
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[6] += get_mS(t_iso_begin, t_end);
+  accT[0] += get_mS(t_begin, t_end);
+
+  // absorb site into half-row/column tensor
+  t_begin = std::chrono::high_resolution_clock::now();
+  ITensor T = T_L[h];
+  absorbSiteBraKet(T, id);
+  auto cmbUp = combiner(ea[7], braKet(1)[0], braKet(1)[1]);
+  T *= cmbRow;
+  T *= P;
+  T *= reindex(cmbUp, combinedIndex(cmbUp), prime(ir));
+  T *= prime(P);
+
+  // symmetrize with respect to exchange of ip and ip'
+  auto tmp = Index("tmp", x);
+  auto Ts = reindex(T, ip, tmp);
+  Ts = reindex(Ts, prime(ip), ip);
+  Ts = reindex(Ts, tmp, prime(ip));
+  T = 0.5 * (T + Ts);
+  normalizeBLE_T(T);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[9] += get_mS(t_begin, t_end);
+  accT[1] += get_mS(t_begin, t_end);
+
+  // copy into all corners and half-row/column tensors
+  t_begin = std::chrono::high_resolution_clock::now();
+
+  auto corner = [&cdiag, &c_max, this](Index const& i0, Index const& i1) {
+    ITensor c(i0, i1);
+    for (int k = 1; k <= x; k++)
+      c.set(i0(k), i1(k), cdiag[k - 1] / c_max);
+    return c;
+  };
+
+  auto halfRowColumn = [&T, &ip, &braKet](Index const& i0, Index const& i1,
+                                          int dir) {
+    auto t = reindex(T, prime(ip), i0);
+    t = reindex(t, ip, i1);
+    if (dir != 2) {
+      t = reindex(t, braKet(2)[0], braKet(dir)[0]);
+      t = reindex(t, braKet(2)[1], braKet(dir)[1]);
+    }
+    return t;
+  };
+
+  C_LU[h] = corner(ea[7], ea[0]);
+  C_RU[h] = corner(ea[1], ea[2]);
+  C_RD[h] = corner(ea[3], ea[4]);
+  C_LD[h] = corner(ea[5], ea[6]);
+  T_L[h] = halfRowColumn(ea[7], ea[6], 0);
+  T_U[h] = halfRowColumn(ea[0], ea[1], 1);
+  T_R[h] = halfRowColumn(ea[2], ea[3], 2);
+  T_D[h] = halfRowColumn(ea[5], ea[4], 3);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[3] += get_mS(t_begin, t_end);
+
+  // record spectra and discarded weight, equal for all directions
+  std::vector<double> sv(nx);
+  for (int k = 0; k < nx; k++)
+    sv[k] = std::abs(cdiag[k]) / c_max;
+  for (int direction = 0; direction < 4; direction++) {
+    spec.sv[direction] = std::vector<std::vector<double>>(1, sv);
+    isoTruncErr[direction] = (w_total > 0.0) ? 1.0 - w_kept / w_total : 0.0;
+  }
+  isoComputed++;
+}
@@ -274,6 +274,7 @@ void setOnSiteTensorsFromJSON(Cluster& c, nlohmann::json const& j, bool dbg) {
       c.caux[id][i - 1] = tmp.first[i];
     c.sites[id] = tmp.second;  // tensor
   }
+  c.siteVersion++;
 }
 
 void writeOnSiteTElems(vector<string>& tEs,
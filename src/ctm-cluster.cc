@@ -1,5 +1,6 @@
 #include "pi-peps/config.h"
 #include "pi-peps/ctm-cluster.h"
+#include <array>
 
 using namespace itensor;
 
@@ -53,11 +54,45 @@ void Cluster::normalize(std::string norm_type) {
       sites.at(id) *= std::pow(iso_tot_mag, (0.5 / siteIds.size()));
     }
   } else if (norm_type == "NONE") {
+    return;
   } else {
     std::cout << "Unsupported on-site tensor normalisation after full update: "
               << norm_type << std::endl;
     exit(EXIT_FAILURE);
   }
+  siteVersion++;
+}
+
+void Cluster::symmetrizeC4v() {
+  int const tmp_prime_offset = 100;
+
+  // images of directions 0,1,2,3 under rotations i -> i+k and reflections
+  // i -> k-i (mod 4)
+  std::vector<std::array<int, 4>> g;
+  for (int k = 0; k < 4; k++) {
+    g.push_back({{k, (k + 1) % 4, (k + 2) % 4, (k + 3) % 4}});
+    g.push_back({{k, (k + 3) % 4, (k + 2) % 4, (k + 1) % 4}});
+  }
+
+  for (auto const& id : siteIds) {
+    auto const& aux = caux.at(id);
+    for (int dir = 1; dir < 4; dir++)
+      if (aux[dir].m() != aux[0].m())
+        throw std::runtime_error(
+          "[Cluster::symmetrizeC4v] Unequal auxiliary dimensions of " + id);
+
+    auto const& A = sites.at(id);
+    ITensor sym;
+    for (auto const& p : g) {
+      auto t = A;
+      for (int dir = 0; dir < 4; dir++)
+        t *= delta(aux[dir], prime(aux[p[dir]], tmp_prime_offset));
+      t.prime(AUXLINK, -tmp_prime_offset);
+      sym = sym ? sym + t : t;
+    }
+    sites.at(id) = (1.0 / g.size()) * sym;
+  }
+  siteVersion++;
 }
 
 void initClusterWeights(Cluster& c, bool dbg) {
@@ -133,6 +168,7 @@ void Cluster::absorbWeightsToSites(bool dbg) {
       }
     }
     weights_absorbed = true;
+    siteVersion++;
   } else {
     std::cout << "[absorbWeightsToSites] Weights already absorbed" << std::endl;
   }
@@ -170,6 +206,7 @@ void Cluster::absorbWeightsToLinks(bool dbg) {
       }
     }
     weights_absorbed = false;
+    siteVersion++;
   } else {
     std::cout << "[absorbWeightsToLinks] Weights are not absorbed to sites"
               << std::endl;
@@ -0,0 +1,327 @@
+#include "pi-peps/config.h"
+#include "pi-peps/ctm-env.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace itensor;
+
+// Binary checkpoint of the environment. All integers are stored as
+// int32/int64 and all elements as (pairs of) doubles in native byte order
+//
+//   magic "PEPSENV1"
+//   fingerprint: sizeN, sizeM, #sites, for each site: id, aux dims (4)
+//   x, for each site: eaux (8 times: name, dim, type, prime level)
+//   for each site: C_LU, C_RU, C_RD, C_LD, T_L, T_U, T_R, T_D
+//
+// Each tensor is stored as its list of indices, identified by their role
+// rather than their id, followed by its elements in the order given by
+// combiner over the same list. Index kinds are
+//
+//   0: eaux[site][k]                   - (k)
+//   1: faux[site][k]                   - (k)
+//   2: auxiliary index of cluster site - (site, dir, prime level relative
+//                                          to the one of AIc(site, dir))
+//
+// such that the environment can be restored for a cluster with the same
+// layout, but newly generated indices
+namespace {
+
+  char const ENV_MAGIC[8] = {'P', 'E', 'P', 'S', 'E', 'N', 'V', '1'};
+
+  class EnvWriter {
+   public:
+    explicit EnvWriter(std::string const& filename)
+      : out(filename, std::ios::out | std::ios::binary) {
+      if (!out.good())
+        throw std::runtime_error("[writeEnv] Failed opening file: " +
+                                 filename);
+    }
+
+    template <typename T>
+    void put(T const& v) {
+      out.write(reinterpret_cast<char const*>(&v), sizeof(T));
+    }
+
+    void putStr(std::string const& s) {
+      put<std::int32_t>(s.size());
+      out.write(s.data(), s.size());
+    }
+
+    template <typename T>
+    void putArray(std::vector<T> const& v) {
+      put<std::int64_t>(v.size());
+      out.write(reinterpret_cast<char const*>(v.data()), v.size() * sizeof(T));
+    }
+
+   private:
+    std::ofstream out;
+  };
+
+  // read-only view of the whole file, mapped into memory
+  class EnvReader {
+   public:
+    explicit EnvReader(std::string const& filename) : fname(filename) {
+      fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw std::runtime_error("[initFromFile] Failed opening file: " +
+                                 filename);
+      struct stat st;
+      if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("[initFromFile] Empty file: " + filename);
+      }
+      size = st.st_size;
+      void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("[initFromFile] mmap failed: " + filename);
+      }
+      data = static_cast<char const*>(p);
+    }
+
+    ~EnvReader() {
+      munmap(const_cast<char*>(data), size);
+      close(fd);
+    }
+
+    EnvReader(EnvReader const&) = delete;
+    EnvReader& operator=(EnvReader const&) = delete;
+
+    char const* take(std::size_t n) {
+      if (pos + n > size)
+        throw std::runtime_error("[initFromFile] Truncated file: " + fname);
+      auto p = data + pos;
+      pos += n;
+      return p;
+    }
+
+    template <typename T>
+    T get() {
+      T v;
+      std::memcpy(&v, take(sizeof(T)), sizeof(T));
+      return v;
+    }
+
+    std::string getStr() {
+      auto n = get<std::int32_t>();
+      return std::string(take(n), n);
+    }
+
+    template <typename T>
+    std::vector<T> getArray() {
+      auto n = get<std::int64_t>();
+      std::vector<T> v(n);
+      std::memcpy(v.data(), take(n * sizeof(T)), n * sizeof(T));
+      return v;
+    }
+
+   private:
+    std::string fname;
+    int fd = -1;
+    std::size_t size = 0;
+    std::size_t pos = 0;
+    char const* data = nullptr;
+  };
+
+}  // namespace
+
+void CtmEnv::writeEnv(std::string const& filename) const {
+  auto const& ids = p_cluster->siteIds;
+  int const nSites = ids.size();
+  EnvWriter w(filename);
+
+  w.put(ENV_MAGIC);
+  w.put<std::int32_t>(sizeN);
+  w.put<std::int32_t>(sizeM);
+  w.put<std::int32_t>(nSites);
+  for (auto const& id : ids) {
+    w.putStr(id);
+    for (int dir = 0; dir < 4; dir++)
+      w.put<std::int32_t>(p_cluster->AIc(id, dir).m());
+  }
+
+  w.put<std::int32_t>(x);
+  for (int h = 0; h < nSites; h++) {
+    for (auto const& i : eaux[h]) {
+      w.putStr(i.rawname());
+      w.put<std::int32_t>(i.m());
+      w.put<std::int32_t>(static_cast<int>(i.type()));
+      w.put<std::int32_t>(i.primeLevel());
+    }
+  }
+
+  auto writeIndex = [&](Index const& i, int h) {
+    for (int k = 0; k < 8; k++)
+      if (i == eaux[h][k]) {
+        w.put<std::int8_t>(0);
+        w.put<std::int32_t>(k);
+        return;
+      }
+    for (int k = 0; k < 4; k++)
+      if (i == faux[h][k]) {
+        w.put<std::int8_t>(1);
+        w.put<std::int32_t>(k);
+        return;
+      }
+    for (int s = 0; s < nSites; s++)
+      for (int dir = 0; dir < 4; dir++) {
+        auto const& a = p_cluster->AIc(ids[s], dir);
+        if (noprime(i) == noprime(a)) {
+          w.put<std::int8_t>(2);
+          w.put<std::int32_t>(s);
+          w.put<std::int32_t>(dir);
+          w.put<std::int32_t>(i.primeLevel() - a.primeLevel());
+          return;
+        }
+      }
+    throw std::runtime_error("[writeEnv] Unknown index of environment: " +
+                             i.rawname());
+  };
+
+  for (int h = 0; h < nSites; h++) {
+    for (auto const* e :
+         {&C_LU, &C_RU, &C_RD, &C_LD, &T_L, &T_U, &T_R, &T_D}) {
+      auto const& t = (*e)[h];
+      std::vector<Index> inds(t.inds().begin(), t.inds().end());
+      w.put<std::int32_t>(inds.size());
+      for (auto const& i : inds)
+        writeIndex(i, h);
+
+      auto cmb = combiner(inds);
+      auto v = t * cmb;
+      auto ci = combinedIndex(cmb);
+      bool const cplx = isComplex(v);
+      w.put<std::int8_t>(cplx);
+      if (cplx) {
+        std::vector<Cplx> elems(ci.m());
+        for (int k = 1; k <= ci.m(); k++)
+          elems[k - 1] = v.cplx(ci(k));
+        w.putArray(elems);
+      } else {
+        std::vector<Real> elems(ci.m());
+        for (int k = 1; k <= ci.m(); k++)
+          elems[k - 1] = v.real(ci(k));
+        w.putArray(elems);
+      }
+    }
+  }
+}
+
+void CtmEnv::initFromFile(std::string const& filename, int maxX) {
+  auto const& ids = p_cluster->siteIds;
+  int const nSites = ids.size();
+  EnvReader r(filename);
+
+  // fingerprint of the cluster
+  auto fail = [&filename](std::string const& what) {
+    throw std::runtime_error("[initFromFile] " + filename +
+                             " does not match the cluster: " + what);
+  };
+  if (std::memcmp(r.take(sizeof(ENV_MAGIC)), ENV_MAGIC, sizeof(ENV_MAGIC)))
+    throw std::runtime_error("[initFromFile] Not an environment file: " +
+                             filename);
+  if (r.get<std::int32_t>() != sizeN || r.get<std::int32_t>() != sizeM)
+    fail("size");
+  if (r.get<std::int32_t>() != nSites)
+    fail("number of sites");
+  for (auto const& id : ids) {
+    if (r.getStr() != id)
+      fail("site ids");
+    for (int dir = 0; dir < 4; dir++)
+      if (r.get<std::int32_t>() != p_cluster->AIc(id, dir).m())
+        fail("auxiliary dimension of site " + id);
+  }
+
+  // everything is read into locals first, the environment is modified
+  // only once the whole file has been validated
+  int const newX = r.get<std::int32_t>();
+  if (maxX < 0)
+    maxX = chiMax;
+  if (newX > maxX)
+    throw std::runtime_error("[initFromFile] " + filename + " has x=" +
+                             std::to_string(newX) + " above the maximal x=" +
+                             std::to_string(maxX));
+  auto newEaux = eaux;
+  for (int h = 0; h < nSites; h++) {
+    for (auto& i : newEaux[h]) {
+      auto name = r.getStr();
+      int const m = r.get<std::int32_t>();
+      auto type = static_cast<IndexType>(r.get<std::int32_t>());
+      int const pl = r.get<std::int32_t>();
+      i = Index(name, m, type, pl);
+    }
+  }
+
+  auto corrupted = [&filename] {
+    throw std::runtime_error("[initFromFile] Corrupted file: " + filename);
+  };
+  auto readIndex = [&](int h) -> Index {
+    auto kind = r.get<std::int8_t>();
+    if (kind == 0)
+      return newEaux[h].at(r.get<std::int32_t>());
+    if (kind == 1)
+      return faux[h].at(r.get<std::int32_t>());
+    if (kind == 2) {
+      int const s = r.get<std::int32_t>();
+      int const dir = r.get<std::int32_t>();
+      int const dp = r.get<std::int32_t>();
+      return prime(p_cluster->AIc(ids.at(s), dir), dp);
+    }
+    corrupted();
+    return Index();
+  };
+
+  // C_LU, C_RU, C_RD, C_LD, T_L, T_U, T_R, T_D of every site
+  std::vector<std::array<ITensor, 8>> newEnv(nSites);
+  for (int h = 0; h < nSites; h++) {
+    for (auto& t : newEnv[h]) {
+      std::vector<Index> inds(r.get<std::int32_t>());
+      for (auto& i : inds)
+        i = readIndex(h);
+
+      auto cmb = combiner(inds);
+      auto ci = combinedIndex(cmb);
+      ITensor v;
+      if (r.get<std::int8_t>()) {
+        auto elems = r.getArray<Cplx>();
+        if (static_cast<long>(elems.size()) != ci.m())
+          corrupted();
+        v = ITensor(IndexSet(ci), Dense<Cplx>(std::move(elems)));
+      } else {
+        auto elems = r.getArray<Real>();
+        if (static_cast<long>(elems.size()) != ci.m())
+          corrupted();
+        v = ITensor(IndexSet(ci), Dense<Real>(std::move(elems)));
+      }
+      t = v * dag(cmb);
+    }
+  }
+
+  eaux = std::move(newEaux);
+  setTauxIndices();
+  x = newX;
+  for (int h = 0; h < nSites; h++) {
+    int k = 0;
+    for (auto* e : {&C_LU, &C_RU, &C_RD, &C_LD, &T_L, &T_U, &T_R, &T_D})
+      (*e)[h] = newEnv[h][k++];
+  }
+
+  // everything holding environment indices is rebuilt
+  movePlans = std::vector<CtmMovePlan>(4);
+  isoReuse = std::vector<IsoReuse>(4);
+  for (auto& b : isoBasis)
+    b.clear();
+  resetExtrapolation();
+  spec = CtmSpec();
+  isoTruncErr.assign(4, 0.0);
+
+  std::cout << "INIT_ENV_file from " << filename << " with x=" << x
+            << std::endl;
+  std::cout << std::string(72, '=') << std::endl;
+}
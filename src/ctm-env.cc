@@ -1,5 +1,7 @@
 #include "pi-peps/config.h"
 #include "pi-peps/ctm-env.h"
+#include <algorithm>
+#include <limits>
 
 // TODO Implement convergence check as general function. The actual
 // implementation may vary - difference between SVD decomp,
@@ -37,6 +39,24 @@ CtmEnv::CtmEnv(std::string t_name,
   rsvd_power = args.getInt("rsvd_power", 2);
   rsvd_reortho = args.getInt("rsvd_reortho", 1);
   rsvd_oversampling = args.getInt("rsvd_oversampling", 10);
+  warmstart_iter = args.getInt("warmstart_iter", 2);
+  warmstart_tol = args.getReal("warmstart_tol", 1.0e-6);
+  autoSvdCache = args.getString("auto_svd_cache", "");
+  ctmThreads = std::max(1, args.getInt("ctmThreads", 1));
+  layeredContraction = args.getBool("layeredContraction", false);
+  isoReuseTol = args.getReal("isoReuseTol", 0.0);
+  isoReuseMax = args.getInt("isoReuseMax", 4);
+  chiMax = std::max(x, args.getInt("chiMax", x));
+  chiStep = std::max(1, args.getInt("chiStep", x));
+  chiTruncErr = args.getReal("chiTruncErr", 0.0);
+  chiNoise = args.getReal("chiNoise", 0.0);
+  andersonDepth = args.getInt("andersonDepth", 0);
+  andersonMixing = args.getReal("andersonMixing", 1.0);
+  andersonRestart = args.getReal("andersonRestart", 10.0);
+  andersonReg = args.getReal("andersonReg", 1.0e-10);
+  isoFixGauge = args.getBool("isoFixGauge", andersonDepth > 0);
+  lowPrecisionSwitch = args.getReal("lowPrecisionSwitch", -1.0);
+  envFile = args.getString("envFile", "");
   DBG = args.getBool("dbg", false);
   DBG_LVL = args.getInt("dbgLevel", 0);
 
@@ -58,6 +78,18 @@ CtmEnv::CtmEnv(std::string t_name,
    *  enable us to formulate "insert, absorb & renormalize" algorithm
    */
 
+  // all site-indexed containers share the handles given by order of sites
+  // in c.siteIds
+  C_LU = SiteTensorMap(c.siteIds);
+  auto layout = C_LU.layout();
+  C_RU = C_RD = C_LD = SiteTensorMap(layout);
+  T_L = T_U = T_R = T_D = SiteTensorMap(layout);
+  braket = braketFused = SiteTensorMap(layout);
+  eaux = faux = SiteMap<std::vector<Index>>(layout);
+  itaux = std::vector<SiteMap<std::vector<Index>>>(
+    4, SiteMap<std::vector<Index>>(layout));
+  CMB = SiteMap<std::vector<ITensor>>(layout);
+
   for (auto const& id : c.siteIds) {
     eaux[id] = std::vector<Index>(8);
     eaux[id] = {Index(id + "-" + TAG_I_U, x, ULINK),
@@ -70,31 +102,7 @@ CtmEnv::CtmEnv(std::string t_name,
                 Index(id + "-" + TAG_I_L, x, LLINK)};
   }
 
-  itaux.resize(4);
-  // LEFT T_* tensors
-  for (int direction = 0; direction < 4; direction++)
-    for (auto const& id : c.siteIds)
-      itaux[direction][id].resize(4);
-
-  for (auto const& id : c.siteIds) {
-    itaux[0][id][1] = eaux[id][7];
-    itaux[0][id][3] = eaux[id][6];
-  }
-  // UP T_* tensors
-  for (auto const& id : c.siteIds) {
-    itaux[1][id][0] = eaux[id][0];
-    itaux[1][id][2] = eaux[id][1];
-  }
-  // RIGHT T_* tensors
-  for (auto const& id : c.siteIds) {
-    itaux[2][id][1] = eaux[id][2];
-    itaux[2][id][3] = eaux[id][3];
-  }
-  // DOWN T_* tensors
-  for (auto const& id : c.siteIds) {
-    itaux[3][id][0] = eaux[id][5];
-    itaux[3][id][2] = eaux[id][4];
-  }
+  setTauxIndices();
 
   // Combiners from site AUX indices to I_XH, I_XV
   for (auto const& id : c.siteIds) {
@@ -166,12 +174,6 @@ CtmEnv::CtmEnv(std::string t_name,
   //     }
   // }
 
-  // Construct vectors holding SVD spectrum of corner matrices
-  spec = {
-    std::vector<std::vector<double>>(c.siteIds.size(), std::vector<double>(x)),
-    std::vector<std::vector<double>>(c.siteIds.size(), std::vector<double>(x)),
-    std::vector<std::vector<double>>(c.siteIds.size(), std::vector<double>(x)),
-    std::vector<std::vector<double>>(c.siteIds.size(), std::vector<double>(x))};
 }
 
 /*
@@ -357,10 +359,7 @@ void CtmEnv::initCtmrgEnv(bool dbg) {
 
   int const BRAKET_OFFSET = 4;
 
-  auto TBraKet = [this, &BRAKET_OFFSET](std::string id) -> ITensor {
-    return p_cluster->sites.at(id) *
-           dag(prime(p_cluster->sites.at(id), AUXLINK, BRAKET_OFFSET));
-  };
+  auto TBraKet = [this](std::string id) -> ITensor { return siteBraKet(id); };
 
   auto contractBraKetInd = [this, &BRAKET_OFFSET](ITensor& t, std::string id0,
                                                   int dir0, std::string id1,
@@ -653,6 +652,14 @@ void CtmEnv::initCtmrgEnv(bool dbg) {
 // }
 
 void CtmEnv::init(CtmEnv::INIT_ENV initEnvType, bool isComplex, bool dbg) {
+  // projectors of the previous environment do not apply to the new one
+  isoReuse = std::vector<IsoReuse>(4);
+  resetExtrapolation();
+  spec = CtmSpec();
+  isoTruncErr.assign(4, 0.0);
+  lowPrecision = (lowPrecisionSwitch > 0.0) &&
+                 (initEnvType == INIT_ENV_ctmrg || initEnvType == INIT_ENV_rnd);
+
   switch (initEnvType) {
     case CtmEnv::INIT_ENV_const1: {
       initMockEnv();
@@ -674,20 +681,19 @@ void CtmEnv::init(CtmEnv::INIT_ENV initEnvType, bool isComplex, bool dbg) {
       initRndEnv(isComplex);
       break;
     }
+    case CtmEnv::INIT_ENV_file: {
+      // environment converged at smaller x is embedded into the current x,
+      // a larger one is rejected
+      int const targetX = x;
+      initFromFile(envFile, targetX);
+      if (x < targetX)
+        growChi(targetX, chiNoise);
+      break;
+    }
     default: {
       std::cout << "Unsupported INIT_ENV" << std::endl;
       exit(EXIT_FAILURE);
     }
-      // TODO?
-      // case CtmEnv::INIT_ENV_file: {
-      //     io_env_fmt_type ioEnvFmt = toIO_ENV_FMT(std::string(argv[5]));
-      //     std::string in_files_prefix = std::string(argv[6]);
-
-      //     ctmEnv = CtmEnv("TEST_ENV_2x2",
-      //         readEnv_V2(ioEnvFmt, in_files_prefix, cluster),
-      //         cluster);
-      //     break;
-      // }
   }
 }
 
@@ -1291,33 +1297,38 @@ void CtmEnv::init(CtmEnv::INIT_ENV initEnvType, bool isComplex, bool dbg) {
 //     std::cout <<")"<< std::endl;
 // }
 
-// void CtmEnv::specDist(CtmSpec const& s1, CtmSpec const& s2) const {
-
-//     double d_sClu = 0.0;
-//     double d_sCru = 0.0;
-//     double d_sCrd = 0.0;
-//     double d_sCld = 0.0;
-
-//     for(int i=0; i<x; i++) {
-//         d_sClu += std::pow(std::abs(s1.spec_clu[i]
-//             -s2.spec_clu[i]), 2.0);
-//         d_sCru += std::pow(std::abs(s1.spec_cru[i]
-//             -s2.spec_cru[i]), 2.0);
-//         d_sCrd += std::pow(std::abs(s1.spec_crd[i]
-//             -s2.spec_crd[i]), 2.0);
-//         d_sCld += std::pow(std::abs(s1.spec_cld[i]
-//             -s2.spec_cld[i]), 2.0);
-//     }
-
-//     std::cout <<"Dist(C_lu): "<< std::sqrt(d_sClu) << std::endl;
-//     std::cout <<"Dist(C_ru): "<< std::sqrt(d_sCru) << std::endl;
-//     std::cout <<"Dist(C_rd): "<< std::sqrt(d_sCrd) << std::endl;
-//     std::cout <<"Dist(C_ld): "<< std::sqrt(d_sCld) << std::endl;
-// }
+double CtmEnv::specDist(CtmSpec const& s1, CtmSpec const& s2) const {
+  // unchanged spectra of reused projectors would read as converged. The
+  // previous record s2 may be stale, as it then spans several steps and
+  // overestimates the distance
+  for (int d = 0; d < 4; d++)
+    if (s1.reused[d])
+      return -1.0;
+
+  double dist = 0.0;
+  for (int d = 0; d < 4; d++) {
+    if (s1.sv[d].size() != s2.sv[d].size())
+      return std::numeric_limits<double>::infinity();
+    for (std::size_t h = 0; h < s1.sv[d].size(); h++) {
+      auto const& a = s1.sv[d][h];
+      auto const& b = s2.sv[d][h];
+      if (a.empty() || b.empty())
+        return std::numeric_limits<double>::infinity();
+
+      // missing tail of the shorter spectrum is taken as zero
+      double d_s = 0.0;
+      for (std::size_t i = 0; i < std::max(a.size(), b.size()); i++) {
+        double va = (i < a.size()) ? a[i] : 0.0;
+        double vb = (i < b.size()) ? b[i] : 0.0;
+        d_s += (va - vb) * (va - vb);
+      }
+      dist = std::max(dist, std::sqrt(d_s));
+    }
+  }
+  return dist;
+}
 
-// CtmEnv::CtmSpec CtmEnv::getCtmSpec() const {
-//     return spec;
-// }
+CtmEnv::CtmSpec CtmEnv::getCtmSpec() const { return spec; }
 
 // TODO check consistency between input cluster c and one currently
 // stored in ENV
@@ -1329,6 +1340,141 @@ void CtmEnv::init(CtmEnv::INIT_ENV initEnvType, bool isComplex, bool dbg) {
 // }
 void CtmEnv::updateCluster(Cluster const& c) {
   p_cluster = &c;
+  braketVersion = -1;
+  isoReuse = std::vector<IsoReuse>(4);
+  movePlans = std::vector<CtmMovePlan>(4);
+  resetExtrapolation();
+}
+
+void CtmEnv::setTauxIndices() {
+  for (int direction = 0; direction < 4; direction++)
+    for (auto const& id : p_cluster->siteIds)
+      itaux[direction][id].resize(4);
+
+  // LEFT T_* tensors
+  for (auto const& id : p_cluster->siteIds) {
+    itaux[0][id][1] = eaux[id][7];
+    itaux[0][id][3] = eaux[id][6];
+  }
+  // UP T_* tensors
+  for (auto const& id : p_cluster->siteIds) {
+    itaux[1][id][0] = eaux[id][0];
+    itaux[1][id][2] = eaux[id][1];
+  }
+  // RIGHT T_* tensors
+  for (auto const& id : p_cluster->siteIds) {
+    itaux[2][id][1] = eaux[id][2];
+    itaux[2][id][3] = eaux[id][3];
+  }
+  // DOWN T_* tensors
+  for (auto const& id : p_cluster->siteIds) {
+    itaux[3][id][0] = eaux[id][5];
+    itaux[3][id][2] = eaux[id][4];
+  }
+}
+
+bool CtmEnv::adaptChi() {
+  double truncErr = *std::max_element(isoTruncErr.begin(), isoTruncErr.end());
+  if (x >= chiMax || truncErr <= chiTruncErr)
+    return false;
+
+  growChi(std::min(chiMax, x + chiStep), chiNoise);
+  return true;
+}
+
+bool CtmEnv::switchPrecision(double dist) {
+  if (!lowPrecision || dist < 0.0 || dist >= lowPrecisionSwitch)
+    return false;
+
+  lowPrecision = false;
+  return true;
+}
+
+// Environment indices are replaced by indices of dimension newX and the
+// C, T tensors are embedded into them, padding by zeros. Subsequent CTM
+// moves fill the new subspace, as the enlarged corners have rank
+// up to x*D^2. Noise lifts the exact degeneracy of the padded subspace
+void CtmEnv::growChi(int newX, double noise) {
+  if (newX <= x)
+    return;
+
+  for (auto const& id : p_cluster->siteIds) {
+    int const h = siteHandle(id);
+    std::vector<ITensor> E(8);
+    for (int k = 0; k < 8; k++) {
+      auto const& i = eaux[h][k];
+      auto ni = Index(i.rawname(), newX, i.type(), i.primeLevel());
+      E[k] = ITensor(i, ni);
+      for (int j = 1; j <= i.m(); j++)
+        E[k].set(i(j), ni(j), 1.0);
+      eaux[h][k] = ni;
+    }
+
+    for (auto* e : {&C_LU, &C_RU, &C_RD, &C_LD, &T_U, &T_R, &T_D, &T_L}) {
+      auto& t = (*e)[h];
+      for (auto const& emb : E)
+        if (hasindex(t, emb.inds().front()))
+          t *= emb;
+      if (noise > 0.0) {
+        auto r =
+          isComplex(t) ? randomTensorC(t.inds()) : randomTensor(t.inds());
+        t += (noise * norm(t) / norm(r)) * r;
+      }
+    }
+  }
+  setTauxIndices();
+  x = newX;
+
+  // everything holding environment indices is rebuilt
+  movePlans = std::vector<CtmMovePlan>(4);
+  isoReuse = std::vector<IsoReuse>(4);
+  for (auto& b : isoBasis)
+    b.clear();
+  resetExtrapolation();
+  // discarded weights were measured at the previous x
+  isoTruncErr.assign(4, 0.0);
+}
+
+void CtmEnv::refreshBraKet() const {
+  if (braketVersion >= 0 && braketVersion == p_cluster->siteVersion)
+    return;
+
+  braket.clear();
+  braketFused.clear();
+  for (auto const& id : p_cluster->siteIds) {
+    auto const& site = p_cluster->sites.at(id);
+    auto X = site * dag(prime(site, AUXLINK, p_cluster->BRAKET_OFFSET));
+    braketFused[id] =
+      X * CMB.at(id)[0] * CMB.at(id)[1] * CMB.at(id)[2] * CMB.at(id)[3];
+    braket[id] = std::move(X);
+  }
+  braketVersion = p_cluster->siteVersion;
+}
+
+ITensor const& CtmEnv::siteBraKet(std::string const& id) const {
+  refreshBraKet();
+  return braket.at(id);
+}
+
+ITensor const& CtmEnv::siteBraKet(Vertex const& v) const {
+  return siteBraKet(p_cluster->vertexToId(v));
+}
+
+ITensor const& CtmEnv::siteBraKetFused(std::string const& id) const {
+  refreshBraKet();
+  return braketFused.at(id);
+}
+
+void CtmEnv::absorbSiteBraKet(ITensor& t, std::string const& id) const {
+  if (layeredContraction) {
+    // t holds both bra and ket aux-indices it shares with site. Contracting
+    // ket first and bra second never forms the double-layer tensor
+    auto const& site = p_cluster->sites.at(id);
+    t *= site;
+    t *= dag(prime(site, AUXLINK, p_cluster->BRAKET_OFFSET));
+  } else {
+    t *= siteBraKet(id);
+  }
 }
 
 // CtmData_Full CtmEnv::getCtmData_Full_DBG(bool dbg) const {
@@ -1376,26 +1522,26 @@ std::ostream& CtmEnv::print(std::ostream& s) const {
   s << "]" << std::endl;
 
   s << "eaux: [" << std::endl;
-  for (auto const& e : eaux) {
-    s << e.first << " : ";
-    for (auto const& i : e.second)
+  for (auto const& id : p_cluster->siteIds) {
+    s << id << " : ";
+    for (auto const& i : eaux.at(id))
       s << i << " ";
     s << std::endl;
   }
   s << "]" << std::endl;
 
   s << "CMB: [" << std::endl;
-  for (auto const& e : CMB) {
-    s << e.first << " : ";
+  for (auto const& id : p_cluster->siteIds) {
+    s << id << " : ";
     for (int dir = 0; dir < 4; dir++)
-      s << "dir " << dir << " : " << e.second[dir];
+      s << "dir " << dir << " : " << CMB.at(id)[dir];
   }
   s << "]" << std::endl;
 
   s << "faux: [" << std::endl;
-  for (auto const& e : faux) {
-    s << e.first << " : ";
-    for (auto const& i : e.second)
+  for (auto const& id : p_cluster->siteIds) {
+    s << id << " : ";
+    for (auto const& i : faux.at(id))
       s << i << " ";
     s << std::endl;
   }
@@ -1522,3 +1668,24 @@ CtmEnv::NORMALIZATION toNORMALIZATION(std::string const& normType) {
   std::cout << "Unsupported NORMALIZATION" << std::endl;
   exit(EXIT_FAILURE);
 }
+
+bool supportsLowPrecision(std::string const& svdMethod) {
+  for (auto const& m :
+       {"warmstart", "rsvd", "rsvd-lapack", "lanczos", "arpack"})
+    if (svdMethod == m)
+      return true;
+  return false;
+}
+
+std::vector<int> makeChiLadder(std::vector<int> const& rungs, int x) {
+  if (!std::is_sorted(rungs.begin(), rungs.end()))
+    throw std::runtime_error("[makeChiLadder] rungs must be increasing");
+  if (!rungs.empty() && rungs.back() > x)
+    throw std::runtime_error("[makeChiLadder] rung x=" +
+                             std::to_string(rungs.back()) +
+                             " above the requested x=" + std::to_string(x));
+  auto ladder = rungs;
+  if (ladder.empty() || ladder.back() < x)
+    ladder.push_back(x);
+  return ladder;
+}
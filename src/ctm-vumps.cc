@@ -0,0 +1,327 @@
+#include "pi-peps/config.h"
+#include "pi-peps/ctm-env.h"
+#include "itensor/iterative.h"
+#include <algorithm>
+
+using namespace itensor;
+
+// VUMPS for single-site cluster. The boundary of each edge is a uniform
+// MPS in mixed canonical form, whose physical index is the fused bra-ket
+// pair of the on-site tensor X pointing towards the edge. Each boundary is
+// treated in its own frame (l,u,r,d) of the auxiliary directions of X,
+// with the MPS above X running from l to r. The frames are chosen such
+// that the MPS of LEFT, RIGHT run from top to bottom and the MPS of UP,
+// DOWN from left to right
+//
+//  a0--AC--a1       FL--a0--AC--a1--FR        FL--a0--C--a1--FR
+//      u            |       u       |         |              |
+//   l--X--r    H_AC(AC) =   l--X--r        H_C(C) =  l------r
+//      d            |       d       |         |              |
+//                   FL--b0      b1--FR        FL--b0    b1--FR
+//
+// A single iteration solves for FL, FR with given AL, AR, for AC, C as
+// dominant eigenvectors of H_AC, H_C and recovers AL, AR from the polar
+// decompositions of AC and C
+//
+// Corners are the fixed points of the growth of the quadrants by one row
+// (column) in the bases given by the boundaries. For C_LU
+//
+//  C_LU--a--        C_LU--a--FL_u--a'
+//   |                |        |
+//   b          =   AL_l--s----/
+//                    |
+//                    b'
+//
+// where FL_u is the left fixed point of the channel of UP boundary and
+// AL_l the MPS tensor of LEFT boundary. The remaining corners are
+// obtained analogously, with AR and FR at the far ends of the boundaries.
+// The gauge matrices C of the boundaries are absorbed into C_RU, C_LD and
+// C_RD, such that all T are given by AL
+namespace {
+
+  // auxiliary directions of X in the frame (l,u,r,d) of each boundary
+  int const FRAME[4][4] = {
+    {1, 0, 3, 2},  // LEFT
+    {0, 1, 2, 3},  // UP
+    {1, 2, 3, 0},  // RIGHT
+    {0, 3, 2, 1}   // DOWN
+  };
+
+  // environment indices (eaux) of the bonds a0, a1 of T of each boundary
+  int const ENV_SLOTS[4][2] = {{7, 6}, {0, 1}, {2, 3}, {5, 4}};
+
+  // Linear map exposed to itensor::arnoldi
+  template <typename F>
+  struct LinearMap {
+    F f;
+    long n;
+
+    void product(ITensor const& x, ITensor& b) const { b = f(x); }
+
+    long size() const { return n; }
+  };
+
+  // dominant eigenvector of f with v as initial guess. The phase of the
+  // result is fixed by its overlap with v, which keeps the gauge of the
+  // boundaries between iterations
+  template <typename F>
+  ITensor dominantEigvec(F f,
+                         ITensor const& v,
+                         double tol,
+                         bool keepReal) {
+    long n = 1;
+    for (auto const& i : v.inds())
+      n *= i.m();
+    LinearMap<F> A{f, n};
+    auto w = v / norm(v);
+    arnoldi(A, w, {"ErrGoal", tol, "MaxIter", 32, "MaxRestart", 8});
+
+    auto o = (dag(v) * w).cplx();
+    if (std::abs(o) > 1.0e-14)
+      w *= std::conj(o) / std::abs(o);
+    if (keepReal && isComplex(w))
+      w = realPart(w);
+    return w / norm(w);
+  }
+
+  // unitary factor of polar decomposition A = W*P with rows given by
+  // rowInds. Singular values of A are appended to sv if requested
+  ITensor polarFactor(ITensor const& A,
+                      std::vector<Index> const& rowInds,
+                      std::vector<double>* sv = nullptr) {
+    ITensor U(rowInds), S, V;
+    svd(A, U, S, V, {"Truncate", false});
+    auto u = commonIndex(U, S);
+    auto v = commonIndex(S, V);
+    if (sv)
+      for (int k = 1; k <= u.m(); k++)
+        sv->push_back(S.real(u(k), v(k)));
+    return U * delta(u, v) * V;
+  }
+
+}  // namespace
+
+void CtmEnv::move_vumps(std::vector<double>& accT) {
+  if (p_cluster->siteIds.size() != 1)
+    throw std::runtime_error("[move_vumps] Cluster with single site required");
+
+  using time_point = std::chrono::high_resolution_clock::time_point;
+  time_point t_begin, t_end;
+  auto get_mS = [](time_point ti, time_point tf) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tf - ti)
+             .count() /
+           1000.0;
+  };
+
+  auto const& id = p_cluster->siteIds[0];
+  int const h = siteHandle(id);
+  auto const ea = eaux[h];
+  auto const& X = siteBraKetFused(id);
+  bool const keepReal = !isComplex(X);
+  std::vector<Index> ci(4);
+  for (int dir = 0; dir < 4; dir++)
+    ci[dir] = combinedIndex(CMB.at(id)[dir]);
+
+  // boundaries are (re)initialized from T, whenever x or the on-site
+  // indices have changed
+  std::vector<ITensor const*> envT = {&T_L[h], &T_U[h], &T_R[h], &T_D[h]};
+  bool restart = false;
+  for (int k = 0; k < 4; k++) {
+    auto& b = vumps[k];
+    auto const& iu = ci[FRAME[k][1]];
+    if (b.AL && b.a0.m() == x && hasindex(b.AL, iu))
+      continue;
+
+    restart = true;
+    auto name = id + "-vumps" + std::to_string(k);
+    b.a0 = Index(name + "-a0", x);
+    b.a1 = Index(name + "-a1", x);
+    b.b0 = Index(name + "-b0", x);
+    b.b1 = Index(name + "-b1", x);
+    b.t = Index(name + "-t", x);
+
+    auto AC = (*envT[k]) * CMB.at(id)[FRAME[k][1]];
+    AC = reindex(AC, ea[ENV_SLOTS[k][0]], b.a0);
+    AC = reindex(AC, ea[ENV_SLOTS[k][1]], b.a1);
+    b.AL = polarFactor(AC, {b.a0, iu});
+    b.AR = polarFactor(AC, {b.a0});
+    b.C = delta(b.a0, b.a1) / std::sqrt(static_cast<double>(x));
+    b.FL = randomTensor(b.a0, ci[FRAME[k][0]], b.b0);
+    b.FR = randomTensor(b.a1, ci[FRAME[k][2]], b.b1);
+    b.err = 1.0;
+  }
+  if (restart)
+    for (auto& c : vumpsCorners)
+      c = ITensor();
+
+  // single VUMPS iteration for each boundary
+  t_begin = std::chrono::high_resolution_clock::now();
+  std::vector<std::vector<double>> sv(4);
+  for (int k = 0; k < 4; k++) {
+    auto& b = vumps[k];
+    auto const& il = ci[FRAME[k][0]];
+    auto const& iu = ci[FRAME[k][1]];
+    auto const& ir = ci[FRAME[k][2]];
+    auto const& iv = ci[FRAME[k][3]];
+    double const tol = std::max(1.0e-13, 0.1 * b.err);
+
+    auto bra = [&b, &iu, &iv](ITensor const& A) {
+      auto t = reindex(dag(A), b.a0, b.b0);
+      t = reindex(t, b.a1, b.b1);
+      return reindex(t, iu, iv);
+    };
+
+    // fixed points of the channel
+    auto const ALbra = bra(b.AL);
+    auto const ARbra = bra(b.AR);
+    auto EL = [&](ITensor const& FL) {
+      auto t = FL * b.AL;
+      t *= X;
+      t *= ALbra;
+      t = reindex(t, b.a1, b.a0);
+      t = reindex(t, ir, il);
+      return reindex(t, b.b1, b.b0);
+    };
+    auto ER = [&](ITensor const& FR) {
+      auto t = FR * b.AR;
+      t *= X;
+      t *= ARbra;
+      t = reindex(t, b.a0, b.a1);
+      t = reindex(t, il, ir);
+      return reindex(t, b.b0, b.b1);
+    };
+    b.FL = dominantEigvec(EL, b.FL, tol, keepReal);
+    b.FR = dominantEigvec(ER, b.FR, tol, keepReal);
+
+    // center site and bond
+    auto HAC = [&](ITensor const& AC) {
+      auto t = b.FL * AC;
+      t *= X;
+      t *= b.FR;
+      t = reindex(t, b.b0, b.a0);
+      t = reindex(t, iv, iu);
+      return reindex(t, b.b1, b.a1);
+    };
+    auto const FRl = reindex(b.FR, ir, il);
+    auto HC = [&](ITensor const& C) {
+      auto t = b.FL * C;
+      t *= FRl;
+      t = reindex(t, b.b0, b.a0);
+      return reindex(t, b.b1, b.a1);
+    };
+    auto AC = reindex(b.AL, b.a1, b.t) * reindex(b.C, b.a0, b.t);
+    AC = dominantEigvec(HAC, AC, tol, keepReal);
+    b.C = dominantEigvec(HC, b.C, tol, keepReal);
+
+    // AL = W(AC)*W(C)^dag, AR = W(C)^dag*W(AC)
+    auto WC = polarFactor(b.C, {b.a0}, &sv[k]);
+    auto WACl = polarFactor(AC, {b.a0, iu});
+    auto WACr = polarFactor(AC, {b.a0});
+    b.AL = reindex(WACl, b.a1, b.t) *
+           reindex(reindex(dag(WC), b.a1, b.t), b.a0, b.a1);
+    b.AR = reindex(reindex(dag(WC), b.a0, b.t), b.a1, b.a0) *
+           reindex(WACr, b.a0, b.t);
+
+    auto ALC = reindex(b.AL, b.a1, b.t) * reindex(b.C, b.a0, b.t);
+    auto CAR = reindex(b.C, b.a1, b.t) * reindex(b.AR, b.a0, b.t);
+    b.err = std::max(norm(AC - ALC), norm(AC - CAR));
+  }
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[6] += get_mS(t_begin, t_end);
+  accT[0] += get_mS(t_begin, t_end);
+
+  // fixed points of corners
+  t_begin = std::chrono::high_resolution_clock::now();
+  auto const& bl = vumps[LEFT];
+  auto const& bu = vumps[UP];
+  auto const& br = vumps[RIGHT];
+  auto const& bd = vumps[DOWN];
+  double const tolC =
+    std::max(1.0e-13, 0.1 * std::max({bl.err, bu.err, br.err, bd.err}));
+
+  auto growLU = [&](ITensor const& C) {
+    auto t = C * bl.AL;
+    t *= bu.FL;
+    t = reindex(t, bl.a1, bl.a0);
+    return reindex(t, bu.b0, bu.a0);
+  };
+  auto growRU = [&](ITensor const& C) {
+    auto t = C * br.AL;
+    t *= bu.FR;
+    t = reindex(t, br.a1, br.a0);
+    return reindex(t, bu.b1, bu.a1);
+  };
+  auto growLD = [&](ITensor const& C) {
+    auto t = reindex(C, bl.a0, bl.a1) * bl.AR;
+    t *= bd.FL;
+    return reindex(t, bd.b0, bd.a0);
+  };
+  auto growRD = [&](ITensor const& C) {
+    auto t = reindex(C, br.a0, br.a1) * br.AR;
+    t *= bd.FR;
+    return reindex(t, bd.b1, bd.a1);
+  };
+
+  auto& cs = vumpsCorners;
+  cs[0] = dominantEigvec(growLU, cs[0] ? cs[0] : randomTensor(bl.a0, bu.a0),
+                         tolC, keepReal);
+  cs[1] = dominantEigvec(growRU, cs[1] ? cs[1] : randomTensor(bu.a1, br.a0),
+                         tolC, keepReal);
+  cs[2] = dominantEigvec(growLD, cs[2] ? cs[2] : randomTensor(bl.a0, bd.a0),
+                         tolC, keepReal);
+  cs[3] = dominantEigvec(growRD, cs[3] ? cs[3] : randomTensor(bd.a1, br.a0),
+                         tolC, keepReal);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[1] += get_mS(t_begin, t_end);
+
+  // C and T in the gauge of AL
+  t_begin = std::chrono::high_resolution_clock::now();
+  auto toEnv = [&ea](ITensor t, Index const& i, int slot) {
+    return reindex(t, i, ea[slot]);
+  };
+
+  std::vector<ITensor*> outT = {&T_L[h], &T_U[h], &T_R[h], &T_D[h]};
+  for (int k = 0; k < 4; k++) {
+    auto const& b = vumps[k];
+    auto t = b.AL * CMB.at(id)[FRAME[k][1]];
+    t = toEnv(t, b.a0, ENV_SLOTS[k][0]);
+    *outT[k] = toEnv(t, b.a1, ENV_SLOTS[k][1]);
+  }
+
+  C_LU[h] = toEnv(toEnv(cs[0], bl.a0, 7), bu.a0, 0);
+
+  auto c = bu.C * cs[1];
+  C_RU[h] = toEnv(toEnv(c, bu.a0, 1), br.a0, 2);
+
+  c = bl.C * reindex(cs[2], bl.a0, bl.a1);
+  C_LD[h] = toEnv(toEnv(c, bl.a0, 6), bd.a0, 5);
+
+  c = reindex(bd.C * cs[3], br.a0, br.a1) * br.C;
+  C_RD[h] = toEnv(toEnv(c, bd.a0, 4), br.a0, 3);
+
+  for (auto* e : {&C_LU[h], &C_RU[h], &C_RD[h], &C_LD[h]})
+    *e /= norm(*e);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[3] += get_mS(t_begin, t_end);
+
+  // spectra of the boundaries (singular values of C) and errors. The
+  // weight of the smallest Schmidt value estimates the error due to
+  // finite x
+  for (int direction = 0; direction < 4; direction++) {
+    auto& s = sv[direction];
+    double w_total = 0.0;
+    for (auto const& e : s)
+      w_total += e * e;
+    double const s_min =
+      s.empty() ? 0.0 : *std::min_element(s.begin(), s.end());
+    isoTruncErr[direction] = (w_total > 0.0) ? s_min * s_min / w_total : 0.0;
+    vumpsErr[direction] = vumps[direction].err;
+
+    double const s_max =
+      s.empty() ? 1.0 : *std::max_element(s.begin(), s.end());
+    for (auto& e : s)
+      e /= s_max;
+    spec.sv[direction] = std::vector<std::vector<double>>(1, s);
+  }
+  isoComputed++;
+}
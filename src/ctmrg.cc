@@ -1,5 +1,6 @@
 #include "pi-peps/config.h"
 #include "pi-peps/ctm-env.h"
+#include <array>
 
 using namespace itensor;
 
@@ -63,9 +64,45 @@ void CtmEnv::move_unidirectional(DIRECTION direction,
 void CtmEnv::move_singleDirection(DIRECTION direction,
                                   ISOMETRY iso_type,
                                   std::vector<double>& accT) {
+  std::vector<CtmMove> moves(1);
+  moves[0].direction = direction;
+  moves[0].iso_type = iso_type;
+  performMoves(moves, accT);
+}
+
+// LEFT and RIGHT (UP and DOWN) moves write disjoint sets of environment
+// tensors. Hence both moves of the pair are computed from the same
+// environment, with their per-site tasks scheduled together, and the new
+// tensors are committed once both moves are done.
+//
+// Unlike the sequence of move_unidirectional in directions L,U,R,D, where
+// each move sees the result of the previous one, the moves are ordered
+// L,R,U,D and the RIGHT (DOWN) move does not see the tensors produced by
+// the LEFT (UP) move of the same step (Jacobi- rather than Gauss-Seidel
+// like update). A single sweep therefore yields a different environment,
+// while the fixed point is the same. The result does not depend on
+// ctmThreads
+void CtmEnv::sweep(ISOMETRY iso_type, std::vector<double>& accT) {
+  std::vector<std::vector<DIRECTION>> pairs = {
+    {DIRECTION::LEFT, DIRECTION::RIGHT}, {DIRECTION::UP, DIRECTION::DOWN}};
+  std::vector<int> lengths = {p_cluster->lX, p_cluster->lY};
+
+  for (int p = 0; p < 2; p++) {
+    for (int i = 0; i < lengths[p]; i++) {
+      std::vector<CtmMove> moves(2);
+      for (int k = 0; k < 2; k++) {
+        moves[k].direction = pairs[p][k];
+        moves[k].iso_type = iso_type;
+      }
+      performMoves(moves, accT);
+    }
+  }
+}
+
+void CtmEnv::performMoves(std::vector<CtmMove>& moves,
+                          std::vector<double>& accT) {
   using time_point = std::chrono::high_resolution_clock::time_point;
-  auto BRAKET_OFFSET = p_cluster->BRAKET_OFFSET;
-  auto sites = p_cluster->sites;
+  time_point t_begin, t_end;
 
   auto get_mS = [](time_point ti, time_point tf) {
     return std::chrono::duration_cast<std::chrono::microseconds>(tf - ti)
@@ -73,43 +110,185 @@ void CtmEnv::move_singleDirection(DIRECTION direction,
            1000.0;
   };
 
+  // Compute isometries, or take them over from the previous move
+  t_begin = std::chrono::high_resolution_clock::now();
+  for (auto& m : moves)
+    m.reuseIso = loadIsometries(m);
+  computeIsometries(moves, accT);
+  for (auto const& m : moves)
+    storeIsometries(m);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[0] += get_mS(t_begin, t_end);
+
+  // Absorb and reduce. Index plumbing (combiners, deltas) for every site
+  // is held by the plan of the move, which is built serially, since
+  // creation of new itensor::Index draws from a global id generator which
+  // is not thread-safe. The contractions, which for every (move, site)
+  // write a different element of nC, nT, nCt, are distributed over
+  // ctmThreads threads
+  int const nSites = p_cluster->siteIds.size();
+  int const nTasks = moves.size() * nSites;
+  for (auto& m : moves)
+    prepareAbsorption(m);
+
+  t_begin = std::chrono::high_resolution_clock::now();
+#ifdef PEPS_WITH_OPENMP
+#pragma omp parallel for num_threads(ctmThreads) schedule(dynamic, 1)
+#endif
+  for (int k = 0; k < nTasks; k++)
+    absorbSite(moves[k / nSites], k % nSites);
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[1] += get_mS(t_begin, t_end);
+
+  // timings of individual sites are reduced in fixed order
+  for (auto const& m : moves) {
+    for (auto const& t : m.absorbT) {
+      accT[8] += t[0];
+      accT[9] += t[1];
+      accT[10] += t[2];
+    }
+  }
+
+  // Post-process the indices of new environment tensors
+  t_begin = std::chrono::high_resolution_clock::now();
+#ifdef PEPS_WITH_OPENMP
+#pragma omp parallel for num_threads(ctmThreads) schedule(dynamic, 1)
+#endif
+  for (int k = 0; k < nTasks; k++)
+    postprocessSite(moves[k / nSites], k % nSites);
+
+  // Update environment tensors by swapping in the back buffers
+  for (auto& m : moves) {
+    m.C->swap(m.nC);
+    m.T->swap(m.nT);
+    m.Ct->swap(m.nCt);
+  }
+  t_end = std::chrono::high_resolution_clock::now();
+  accT[3] += get_mS(t_begin, t_end);
+}
+
+CtmEnv::CtmMovePlan const& CtmEnv::movePlan(DIRECTION direction) const {
+  auto& pl = movePlans.at(direction);
+  if (pl.cluster != p_cluster) {
+    pl = CtmMovePlan();
+    buildMovePlan(direction, pl);
+    pl.cluster = p_cluster;
+  }
+  return pl;
+}
+
+void CtmEnv::buildMovePlan(DIRECTION direction, CtmMovePlan& pl) const {
+  int const tmp_prime_offset = 100;
   auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
 
+  auto edgeIndices = [this](CtmEnv::DIRECTION direction, Vertex const& v,
+                            int dir) {
+    std::vector<Index> tmp = p_cluster->AIBraKetPair(v, dir);
+    tmp.emplace_back(tauxByVertex(direction, v, dir));
+    return tmp;
+  };
+
   auto deltaEdgeT = [this](CtmEnv::DIRECTION direction, Vertex const& v0,
                            int dir0, Vertex const& v1, int dir1) {
     return delta(tauxByVertex(direction, v0, dir0),
                  tauxByVertex(direction, v1, dir1));
   };
 
-  auto reindexSiteToSite = [this](ITensor& t, Vertex const& v0, int dir0,
-                                  Vertex const& v1, int dir1) {
-    // relabel site auxiliary indices
+  auto randomRank1 = [](ITensor const& t) {
+    ITensor res;
+    for (auto const& i : t.inds())
+      res = res ? res * randomTensor(i) : randomTensor(i);
+    return res;
+  };
+
+  auto deltaSiteToSite = [this](Vertex const& v0, int dir0, Vertex const& v1,
+                                int dir1) {
+    // relabel site auxiliary indices of ket and bra
     auto tmp_delta = p_cluster->DContract(v0, dir0, v1, dir1);
-    t *= tmp_delta;
-    t *= tmp_delta.prime(p_cluster->BRAKET_OFFSET);
+    return std::array<ITensor, 2>{
+      {tmp_delta, prime(tmp_delta, p_cluster->BRAKET_OFFSET)}};
   };
 
-  // Compute isometries
-  time_point t_iso_begin, t_iso_end;
-  t_iso_begin = std::chrono::high_resolution_clock::now();
-  std::map<std::string, Index> ip, ipt;
-  std::map<std::string, ITensor> P, Pt;
-  switch (iso_type) {
-    case ISOMETRY_T3: {
-      compute_IsometriesT3(direction, ip, ipt, P, Pt, accT);
+  // Corners to be used in construction of projectors
+  switch (direction) {
+    case DIRECTION::LEFT: {
+      // ISOMETRY_T3           ISOMETRY_T4
+      // P   v--------2        P   v--------v+(1,0)
+      //     3                     3        3 <-- indices of U
+      //     1                     1        1
+      // Pt  v+(0,1)--2        Pt  v+(0,1)--v+(1,1)
+      //     ^--indices of U
+      pl.corner_i = CORNER::LU;
+      pl.corner_it = CORNER::LD;
+      pl.iso_shift = Shift(0, 1);
+      pl.iso_shift_oi = Shift(1, 0);
+      pl.iso_dir0 = 3;
+      pl.iso_dir1 = 1;
+      pl.p_direction = DIRECTION::UP;
+      pl.p_dir = 2;
       break;
     }
-    case ISOMETRY_T4: {
-      compute_IsometriesT4(direction, ip, ipt, P, Pt, accT);
+    case DIRECTION::UP: {
+      // ISOMETRY_T3           ISOMETRY_T4
+      // Pt              P     Pt              P
+      // v+(-1,0)--2 0---v     v+(-1,0)--2 0---v
+      // |               |     |               |
+      // 3               3     v+(-1,1)--2 0---v+(0,1)
+      //                 ^--indices of U (T3)    ^--indices of U (T4)
+      pl.corner_i = CORNER::RU;
+      pl.corner_it = CORNER::LU;
+      pl.iso_shift = Shift(-1, 0);
+      pl.iso_shift_oi = Shift(0, 1);
+      pl.iso_dir0 = 0;
+      pl.iso_dir1 = 2;
+      pl.p_direction = DIRECTION::RIGHT;
+      pl.p_dir = 3;
       break;
     }
+    case DIRECTION::RIGHT: {
+      // ISOMETRY_T3
+      //                  0---v+(0,-1) Pt
+      //                      3
+      //                      1
+      // indices of U --> 0---v P
+      //
+      // ISOMETRY_T4
+      //                  v+(-1,-1)--v+(0,-1) Pt
+      //                  3          3
+      // indices of U --> 1          1
+      //                  v+(-1,0)---v        P
+      pl.corner_i = CORNER::RD;
+      pl.corner_it = CORNER::RU;
+      pl.iso_shift = Shift(0, -1);
+      pl.iso_shift_oi = Shift(-1, 0);
+      pl.iso_dir0 = 1;
+      pl.iso_dir1 = 3;
+      pl.p_direction = DIRECTION::DOWN;
+      pl.p_dir = 0;
+      break;
+    }
+    case DIRECTION::DOWN: {
+      // ISOMETRY_T3               ISOMETRY_T4
+      // indices of U --V          indices of U --V
+      //                1       1       v+(0,-1)--2 0--v+(1,-1)
+      //                |       |       |              |
+      //                v--2 0--v+(1,0) v---------2 0--v+(1,0)
+      //                P       Pt      P              Pt
+      pl.corner_i = CORNER::LD;
+      pl.corner_it = CORNER::RD;
+      pl.iso_shift = Shift(1, 0);
+      pl.iso_shift_oi = Shift(0, -1);
+      pl.iso_dir0 = 2;
+      pl.iso_dir1 = 0;
+      pl.p_direction = DIRECTION::LEFT;
+      pl.p_dir = 1;
+      break;
+    }
+    default:
+      throw std::runtime_error("[compute_Isometries] Invalid direction");
   }
-  t_iso_end = std::chrono::high_resolution_clock::now();
-  accT[0] += get_mS(t_iso_begin, t_iso_end);
+  pl.opposite_direction = toDIRECTION((direction + 2) % 4);
 
-  Shift shift, p_shift;
-  int dir0, dir1;
-  DIRECTION opposite_direction;
   switch (direction) {
     case DIRECTION::LEFT: {
       // C(v)  * Taux(v)  * Pt(v+(0,1))        -> nC(v+(1,0))
@@ -132,11 +311,10 @@ void CtmEnv::move_singleDirection(DIRECTION direction,
       // 3      3
       // Ct(v)--Tauxt(v)
       //
-      shift = Shift(1, 0);
-      p_shift = Shift(0, 1);
-      dir0 = 1;
-      dir1 = 3;
-      opposite_direction = DIRECTION::RIGHT;
+      pl.shift = Shift(1, 0);
+      pl.p_shift = Shift(0, 1);
+      pl.dir0 = 1;
+      pl.dir1 = 3;
       break;
     }
     case DIRECTION::UP: {
@@ -148,239 +326,250 @@ void CtmEnv::move_singleDirection(DIRECTION direction,
       // 2--C(v) |                              | Tauxt(v)--0 0--         --2
       // 0--site(v)--2 0--                       --2 2--Taux(v)
       //
-      shift = Shift(0, -1);
-      p_shift = Shift(-1, 0);
-      dir0 = 2;
-      dir1 = 0;
-      opposite_direction = DIRECTION::DOWN;
+      pl.shift = Shift(0, -1);
+      pl.p_shift = Shift(-1, 0);
+      pl.dir0 = 2;
+      pl.dir1 = 0;
       break;
     }
     case DIRECTION::RIGHT: {
-      shift = Shift(-1, 0);
-      p_shift = Shift(0, -1);
-      dir0 = 3;
-      dir1 = 1;
-      opposite_direction = DIRECTION::LEFT;
+      pl.shift = Shift(-1, 0);
+      pl.p_shift = Shift(0, -1);
+      pl.dir0 = 3;
+      pl.dir1 = 1;
       break;
     }
     case DIRECTION::DOWN: {
-      shift = Shift(0, 1);
-      p_shift = Shift(1, 0);
-      dir0 = 0;
-      dir1 = 2;
-      opposite_direction = DIRECTION::UP;
+      pl.shift = Shift(0, 1);
+      pl.p_shift = Shift(1, 0);
+      pl.dir0 = 0;
+      pl.dir1 = 2;
       break;
     }
     default:
       throw std::runtime_error("[move_singleDirection] Invalid direction");
   }
 
-  // map C T C according to selected direction
-  // to Cu T Cv where u,v 1,2 or 2,3 or 3,4 or 4,1
+  // projectors
+  int const nSites = p_cluster->siteIds.size();
+  pl.iso = std::vector<IsoPlan>(nSites);
+  for (int i = 0; i < nSites; i++) {
+    auto& r = pl.iso[i];
+    r.id = p_cluster->siteIds[i];
+    r.h = siteHandle(r.id);
+    r.v = p_cluster->idToV.at(r.id);
+    r.v_shift = r.v + pl.iso_shift;
+    r.cmb_p_inner = combiner(edgeIndices(direction, r.v, pl.iso_dir0));
+    r.cmb_pt_inner = combiner(edgeIndices(direction, r.v_shift, pl.iso_dir1));
+    r.cmb_p_inner_r = reindex(r.cmb_p_inner, combinedIndex(r.cmb_p_inner),
+                              combinedIndex(r.cmb_pt_inner));
+    r.cmb_halves = build_halves_combiners(direction, r.v);
+    r.U_T3 = ITensor(edgeIndices(pl.p_direction, r.v, pl.p_dir));
+    r.U_T4 = prime(ITensor(edgeIndices(pl.opposite_direction,
+                                       r.v + pl.iso_shift_oi, pl.iso_dir0)),
+                   AUXLINK, tmp_prime_offset);
+    r.gauge_T3 = randomRank1(r.U_T3);
+    r.gauge_T4 = randomRank1(r.U_T4);
+    r.ip = Index("P_" + r.id, tauxByVertex(direction, r.v, pl.iso_dir0).m());
+    r.ipt =
+      Index("Pt_" + r.id, tauxByVertex(direction, r.v, pl.iso_dir1).m());
+  }
 
-  // copy current C,T,C for each X O(x^2) + O(x^2 auxBondDim^2)
-  // depending on the direction
+  // absorption: iterate over pairs (Vertex, Id) within elementary cell of
+  // cluster. Id identifies tensor belonging to Vertex
+  auto const dir0 = pl.dir0;
+  auto const dir1 = pl.dir1;
+  auto const opposite_direction = pl.opposite_direction;
+  pl.absorb = std::vector<AbsorbPlan>(nSites);
+  for (int i = 0; i < nSites; i++) {
+    auto& a = pl.absorb[i];
+    a.id = p_cluster->siteIds[i];
+    a.v = p_cluster->idToV.at(a.id);
+    a.v_shifted = a.v + pl.shift;    // Shift of site
+    a.v_shift_f = a.v + pl.p_shift;  // Shift of projector forward
+    a.v_shift_b = a.v - pl.p_shift;  // Shift of projector backward
+    a.id_shift = vToId(a.v_shifted);
+    a.id_shift_f = vToId(a.v_shift_f);
+    a.id_shift_b = vToId(a.v_shift_b);
+    a.h = siteHandle(a.id);
+    a.h_shift = siteHandle(a.id_shift);
+    a.h_shift_f = siteHandle(a.id_shift_f);
+    a.h_shift_b = siteHandle(a.id_shift_b);
 
-  // clockwise
-  std::map<std::string, ITensor> nC, nT, nCt;
-  std::map<std::string, ITensor>* ptr_oldC;
-  std::map<std::string, ITensor>* ptr_oldT;
-  std::map<std::string, ITensor>* ptr_oldCt;
-  std::map<std::string, ITensor>* ptr_Taux;
-  std::map<std::string, ITensor>* ptr_Tauxt;
-  switch (direction) {
+    // Combine on-site AUXLINK indices of tmp_T = T * P
+    // AND combine on-site AUXLINK indices  tmp_site = sites(id) * sites(id)^dag
+    auto ai_pair_tmp0 = p_cluster->AIBraKetPair(a.v_shift_b, dir1);
+    auto ai_pair_tmp1 = p_cluster->AIBraKetPair(a.v, direction);
+    auto ai_pair_tmp2 = p_cluster->AIBraKetPair(a.v, dir0);
+    a.cmb_T0 = combiner(ai_pair_tmp0[0], ai_pair_tmp0[1], ai_pair_tmp1[0],
+                        ai_pair_tmp1[1]);
+    auto cmb_site = combiner(ai_pair_tmp2[0], ai_pair_tmp2[1], ai_pair_tmp1[0],
+                             ai_pair_tmp1[1]);
+    a.cmb_site_r = reindex(cmb_site, combinedIndex(cmb_site),
+                           combinedIndex(a.cmb_T0));
+
+    ai_pair_tmp0 = p_cluster->AIBraKetPair(a.v, dir1);
+    ai_pair_tmp1 = p_cluster->AIBraKetPair(a.v_shift_f, dir0);
+    auto cmb_T1 = combiner(tauxByVertex(direction, a.v, dir1),
+                           ai_pair_tmp0[0], ai_pair_tmp0[1]);
+    a.cmb_Tr = combiner(tauxByVertex(direction, a.v_shift_f, dir0),
+                        ai_pair_tmp1[0], ai_pair_tmp1[1]);
+    a.cmb_T1_r =
+      reindex(cmb_T1, combinedIndex(cmb_T1), combinedIndex(a.cmb_Tr));
+
+    a.d_T_b = deltaEdgeT(direction, a.v, dir0, a.v_shift_b, dir1);
+    a.d_T_f = deltaEdgeT(direction, a.v, dir1, a.v_shift_f, dir0);
+    a.d_site_b = deltaSiteToSite(a.v_shift_b, dir1, a.v, dir0);
+    a.d_site_f = deltaSiteToSite(a.v, dir1, a.v_shift_f, dir0);
+
+    // relabel indices of new tensors, coming from environment, sites and
+    // projectors, to those of environment at v_shifted. Plans of projectors
+    // are ordered by site handle
+    auto dc_site =
+      p_cluster->DContract(a.id, opposite_direction, a.id_shift, direction);
+    a.post_C = {delta(tauxByVertex(dir0, a.v, opposite_direction),
+                      tauxByVertex(dir0, a.v_shifted, direction)),
+                delta(pl.iso[a.h_shift_b].ipt,
+                      tauxByVertex(direction, a.v_shifted, dir0))};
+    a.post_T = {dc_site, prime(dc_site, p_cluster->BRAKET_OFFSET),
+                delta(pl.iso[a.h_shift_b].ip,
+                      tauxByVertex(direction, a.v_shifted, dir0)),
+                delta(pl.iso[a.h].ipt,
+                      tauxByVertex(direction, a.v_shifted, dir1))};
+    a.post_Ct = {delta(tauxByVertex(dir1, a.v, opposite_direction),
+                       tauxByVertex(dir1, a.v_shifted, direction)),
+                 delta(pl.iso[a.h].ip,
+                       tauxByVertex(direction, a.v_shifted, dir1))};
+  }
+}
+
+void CtmEnv::prepareAbsorption(CtmMove& m) {
+  m.plan = &movePlan(m.direction);
+  switch (m.direction) {
     case DIRECTION::LEFT: {
-      ptr_oldC = &C_LU;
-      ptr_Taux = &T_U;
-      ptr_oldT = &T_L;
-      ptr_oldCt = &C_LD;
-      ptr_Tauxt = &T_D;
+      m.C = &C_LU;
+      m.Taux = &T_U;
+      m.T = &T_L;
+      m.Ct = &C_LD;
+      m.Tauxt = &T_D;
       break;
     }
     case DIRECTION::UP: {
-      ptr_oldC = &C_RU;
-      ptr_Taux = &T_R;
-      ptr_oldT = &T_U;
-      ptr_oldCt = &C_LU;
-      ptr_Tauxt = &T_L;
+      m.C = &C_RU;
+      m.Taux = &T_R;
+      m.T = &T_U;
+      m.Ct = &C_LU;
+      m.Tauxt = &T_L;
       break;
     }
     case DIRECTION::RIGHT: {
-      ptr_oldC = &C_RD;
-      ptr_Taux = &T_D;
-      ptr_oldT = &T_R;
-      ptr_oldCt = &C_RU;
-      ptr_Tauxt = &T_U;
+      m.C = &C_RD;
+      m.Taux = &T_D;
+      m.T = &T_R;
+      m.Ct = &C_RU;
+      m.Tauxt = &T_U;
       break;
     }
     case DIRECTION::DOWN: {
-      ptr_oldC = &C_LD;
-      ptr_Taux = &T_L;
-      ptr_oldT = &T_D;
-      ptr_oldCt = &C_RD;
-      ptr_Tauxt = &T_R;
+      m.C = &C_LD;
+      m.Taux = &T_L;
+      m.T = &T_D;
+      m.Ct = &C_RD;
+      m.Tauxt = &T_R;
       break;
     }
+    default:
+      throw std::runtime_error("[move_singleDirection] Invalid direction");
   }
-  std::map<std::string, ITensor>& C = *ptr_oldC;
-  std::map<std::string, ITensor>& T = *ptr_oldT;
-  std::map<std::string, ITensor>& Ct = *ptr_oldCt;
-  std::map<std::string, ITensor> const& Taux = *ptr_Taux;
-  std::map<std::string, ITensor> const& Tauxt = *ptr_Tauxt;
-
-  // iterate over pairs (Vertex, Id) within elementary cell of cluster
-  // Id identifies tensor belonging to Vertex
-  time_point t0_inner, t1_inner, t00, t11;
-  t_iso_begin = std::chrono::high_resolution_clock::now();
-  for (auto const& id : p_cluster->siteIds) {
-    Vertex const& v = p_cluster->idToV.at(id);
-    Vertex v_shifted = v + shift;    // Shift of site
-    Vertex v_shift_f = v + p_shift;  // Shift of projector forward
-    Vertex v_shift_b = v - p_shift;  // Shift of projector backward
-    std::string id_shift = vToId(v_shifted);
-    std::string id_shift_f = vToId(v_shift_f);
-    std::string id_shift_b = vToId(v_shift_b);
-
-    // ===== Absorb and reduce C ==========================================
-    t0_inner = std::chrono::high_resolution_clock::now();
-    nC[id_shift] = (Taux.at(id) * C[id]) * Pt[id_shift_b];
-    t1_inner = std::chrono::high_resolution_clock::now();
-    accT[8] += get_mS(t0_inner, t1_inner);
-
-    // ===== Absorb and reduce T ==========================================
-    t0_inner = std::chrono::high_resolution_clock::now();
-    // CAUTION delta must be applied to P first, otherwise in the case of 1site
-    // inv PEPS T would be contracted down to rank 1 tensor
-    auto tmp_T =
-      (deltaEdgeT(direction, v, dir0, v_shift_b, dir1) * P[id_shift_b]) * T[id];
-    // t11 = std::chrono::high_resolution_clock::now();
-    // std::cout<< get_mS(t0_inner, t11) << std::endl;
 
-    // Combine on-site AUXLINK indices of tmp_T = T * P
-    // AND combine on-site AUXLINK indices  tmp_site = sites(id) * sites(id)^dag
-    auto ai_pair_tmp0 = p_cluster->AIBraKetPair(v_shift_b, dir1);
-    auto ai_pair_tmp1 = p_cluster->AIBraKetPair(v, direction);
-    auto ai_pair_tmp2 = p_cluster->AIBraKetPair(v, dir0);
-    auto cmb_tmp0 = combiner(ai_pair_tmp0[0], ai_pair_tmp0[1], ai_pair_tmp1[0],
-                             ai_pair_tmp1[1]);
-    auto cmb_tmp1 = combiner(ai_pair_tmp2[0], ai_pair_tmp2[1], ai_pair_tmp1[0],
-                             ai_pair_tmp1[1]);
+  m.absorbT = std::vector<std::array<double, 3>>(p_cluster->siteIds.size());
+  m.nC = SiteTensorMap(m.C->layout());
+  m.nT = SiteTensorMap(m.T->layout());
+  m.nCt = SiteTensorMap(m.Ct->layout());
+}
 
-    // t00 = std::chrono::high_resolution_clock::now();
-    // reindexSiteToSite(tmp_T,v,dir0,v_p_shifted,dir1);
-    // t11 = std::chrono::high_resolution_clock::now();
-    // std::cout<< get_mS(t00, t11) << std::endl;
-
-    // t00 = std::chrono::high_resolution_clock::now();
-    auto tmp_site =
-      (sites.at(id) * dag(prime(sites.at(id), AUXLINK, BRAKET_OFFSET)));
-    tmp_T *= cmb_tmp0;
-    tmp_site *= cmb_tmp1;
-    // TODO use delta instead of reindex
-    tmp_T *=
-      reindex(tmp_site, combinedIndex(cmb_tmp1), combinedIndex(cmb_tmp0));
-
-    // tmp_T *= (sites.at(id) * dag(prime(sites.at(id),AUXLINK,BRAKET_OFFSET)));
-    // t11 = std::chrono::high_resolution_clock::now();
-    // std::cout<< get_mS(t00, t11) << std::endl;
-
-    // t00 = std::chrono::high_resolution_clock::now();
-    // tmp_T *= deltaEdgeT(direction,v,dir1,v_p_shifted,dir0);
-    // reindexSiteToSite(tmp_T,v,dir1,v_p_shifted,dir0);
-    ai_pair_tmp0 = p_cluster->AIBraKetPair(v, dir1);
-    ai_pair_tmp1 = p_cluster->AIBraKetPair(v_shift_f, dir0);
-    cmb_tmp0 = combiner(tauxByVertex(direction, v, dir1), ai_pair_tmp0[0],
-                        ai_pair_tmp0[1]);
-    cmb_tmp1 = combiner(tauxByVertex(direction, v_shift_f, dir0),
-                        ai_pair_tmp1[0], ai_pair_tmp1[1]);
-    // t11 = std::chrono::high_resolution_clock::now();
-    // std::cout<< get_mS(t00, t11) << std::endl;
-
-    // t00 = std::chrono::high_resolution_clock::now();
-    tmp_T *= cmb_tmp0;
-    nT[id_shift] =
-      reindex(tmp_T, combinedIndex(cmb_tmp0), combinedIndex(cmb_tmp1)) *
-      (Pt[id] * cmb_tmp1);
-    t1_inner = std::chrono::high_resolution_clock::now();
-    // std::cout<< get_mS(t00, t1_inner) << std::endl;
-    accT[9] += get_mS(t0_inner, t1_inner);
-
-    // ===== Absorb and reduce Ct =========================================
-    t0_inner = std::chrono::high_resolution_clock::now();
-    nCt[id_shift] = (Tauxt.at(id) * Ct[id]) * P[id];
-    t1_inner = std::chrono::high_resolution_clock::now();
-    accT[10] += get_mS(t0_inner, t1_inner);
-
-    // (dbg) Print(nC[shifted_pos]); Print(nT[shifted_pos]);
-    // Print(nCt[shifted_pos]);
-  }
-  t_iso_end = std::chrono::high_resolution_clock::now();
-  accT[1] += get_mS(t_iso_begin, t_iso_end);
+void CtmEnv::absorbSite(CtmMove& m, int i) const {
+  using time_point = std::chrono::high_resolution_clock::time_point;
 
-  // Post-process the indices of new environment tensors
-  t_iso_begin = std::chrono::high_resolution_clock::now();
+  auto get_mS = [](time_point ti, time_point tf) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tf - ti)
+             .count() /
+           1000.0;
+  };
 
-  for (auto const& id : p_cluster->siteIds) {
-    Vertex const& v = p_cluster->idToV.at(id);
-    Vertex v_shifted = v + shift;    // Shift of site
-    Vertex v_shift_f = v + p_shift;  // Shift of projector forward
-    Vertex v_shift_b = v - p_shift;  // Shift of projector backward
-    std::string id_shift = vToId(v_shifted);
-    std::string id_shift_f = vToId(v_shift_f);
-    std::string id_shift_b = vToId(v_shift_b);
-
-    nC[id_shift] *= delta(tauxByVertex(dir0, v, opposite_direction),
-                          tauxByVertex(dir0, v_shifted, direction));
-    nC[id_shift] *=
-      delta(ipt.at(id_shift_b), tauxByVertex(direction, v_shifted, dir0));
-
-    nT[id_shift] *=
-      p_cluster->DContract(id, opposite_direction, id_shift, direction);
-    nT[id_shift] *=
-      prime(p_cluster->DContract(id, opposite_direction, id_shift, direction),
-            p_cluster->BRAKET_OFFSET);
-    nT[id_shift] *=
-      delta(ip.at(id_shift_b), tauxByVertex(direction, v_shifted, dir0));
-    nT[id_shift] *= delta(ipt.at(id), tauxByVertex(direction, v_shifted, dir1));
-
-    nCt[id_shift] *= delta(tauxByVertex(dir1, v, opposite_direction),
-                           tauxByVertex(dir1, v_shifted, direction));
-    nCt[id_shift] *= delta(ip.at(id), tauxByVertex(direction, v_shifted, dir1));
+  auto const& pl = m.plan->absorb[i];
+  auto& accT = m.absorbT[i];
+  time_point t0_inner, t1_inner;
+
+  // ===== Absorb and reduce C ==========================================
+  t0_inner = std::chrono::high_resolution_clock::now();
+  m.nC[pl.h_shift] = ((*m.Taux)[pl.h] * (*m.C)[pl.h]) * m.Pt[pl.h_shift_b];
+  t1_inner = std::chrono::high_resolution_clock::now();
+  accT[0] = get_mS(t0_inner, t1_inner);
+
+  // ===== Absorb and reduce T ==========================================
+  t0_inner = std::chrono::high_resolution_clock::now();
+  // CAUTION delta must be applied to P first, otherwise in the case of 1site
+  // inv PEPS T would be contracted down to rank 1 tensor
+  auto tmp_T = (pl.d_T_b * m.P[pl.h_shift_b]) * (*m.T)[pl.h];
+
+  if (layeredContraction) {
+    // relabel aux-indices coming from P(v_shift_b) to those of site(v),
+    // absorb ket and bra layers one by one and relabel towards Pt(v)
+    tmp_T *= pl.d_site_b[0];
+    tmp_T *= pl.d_site_b[1];
+    absorbSiteBraKet(tmp_T, pl.id);
+    tmp_T *= pl.d_T_f;
+    tmp_T *= pl.d_site_f[0];
+    tmp_T *= pl.d_site_f[1];
+    m.nT[pl.h_shift] = tmp_T * m.Pt[pl.h];
+  } else {
+    tmp_T *= pl.cmb_T0;
+    tmp_T *= siteBraKet(pl.id) * pl.cmb_site_r;
+    tmp_T *= pl.cmb_T1_r;
+    m.nT[pl.h_shift] = tmp_T * (m.Pt[pl.h] * pl.cmb_Tr);
   }
+  t1_inner = std::chrono::high_resolution_clock::now();
+  accT[1] = get_mS(t0_inner, t1_inner);
 
-  // 	std::cout<<"=DONE====================================================================="<<std::endl;
-  // 	std::cout<< v-p_shift <<"="<< c.vertexToId(v-p_shift) << std::endl;
-  // 	std::cout<< v <<"="<< id <<" --> "<< shifted <<"="<<c.vertexToId(shifted)
-  // 		<<" "<< c.aux[vToPos(shifted)] << std::endl;
-  // 	std::cout<< v+p_shift <<"="<< c.vertexToId(v+p_shift) << std::endl;
+  // ===== Absorb and reduce Ct =========================================
+  t0_inner = std::chrono::high_resolution_clock::now();
+  m.nCt[pl.h_shift] = ((*m.Tauxt)[pl.h] * (*m.Ct)[pl.h]) * m.P[pl.h];
+  t1_inner = std::chrono::high_resolution_clock::now();
+  accT[2] = get_mS(t0_inner, t1_inner);
 
-  // 	Print(nC[shifted_pos]); Print(nT[shifted_pos]); Print(nCt[shifted_pos]);
-  // }
+  // (dbg) Print(nC[shifted_pos]); Print(nT[shifted_pos]);
+  // Print(nCt[shifted_pos]);
+}
 
+void CtmEnv::postprocessSite(CtmMove& m, int i) const {
   // Normalize new corner tensors
   auto normalizeBLE_T = [](ITensor& t) {
-    double m = 0.;
-    auto max_m = [&m](double d) {
-      if (std::abs(d) > m)
-        m = std::abs(d);
+    double max_elem = 0.;
+    auto max_m = [&max_elem](double d) {
+      if (std::abs(d) > max_elem)
+        max_elem = std::abs(d);
     };
 
     t.visit(max_m);
-    t *= 1.0 / m;
+    t *= 1.0 / max_elem;
   };
-  for (auto const& id : p_cluster->siteIds) {
-    normalizeBLE_T(nC.at(id));
-    normalizeBLE_T(nT.at(id));
-    normalizeBLE_T(nCt.at(id));
-  }
 
-  // Update environment tensors
-  C = nC;
-  T = nT;
-  Ct = nCt;
-
-  t_iso_end = std::chrono::high_resolution_clock::now();
-  accT[3] += get_mS(t_iso_begin, t_iso_end);
+  auto const& pl = m.plan->absorb[i];
+  auto& nC_s = m.nC[pl.h_shift];
+  auto& nT_s = m.nT[pl.h_shift];
+  auto& nCt_s = m.nCt[pl.h_shift];
+
+  for (auto const& d : pl.post_C)
+    nC_s *= d;
+  for (auto const& d : pl.post_T)
+    nT_s *= d;
+  for (auto const& d : pl.post_Ct)
+    nCt_s *= d;
+
+  normalizeBLE_T(nC_s);
+  normalizeBLE_T(nT_s);
+  normalizeBLE_T(nCt_s);
 }
 
 // C---I_U,a2,a6
@@ -415,233 +604,188 @@ void CtmEnv::compute_IsometriesT3(DIRECTION direction,
                                   std::map<std::string, ITensor>& P,
                                   std::map<std::string, ITensor>& Pt,
                                   std::vector<double>& accT) const {
-  using time_point = std::chrono::high_resolution_clock::time_point;
-
-  double const machine_eps = std::numeric_limits<double>::epsilon();
-  int const tmp_prime_offset = 100;
-
-  auto get_mS = [](time_point ti, time_point tf) {
-    return std::chrono::duration_cast<std::chrono::microseconds>(tf - ti)
-             .count() /
-           1000.0;
-  };
-
-  auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
-
-  auto readyToContract = [this](ITensor& t, CtmEnv::DIRECTION direction,
-                                Vertex const& v0, int dir0, Vertex const& v1,
-                                int dir1) {
-    // relabel env auxiliary indices
-    t *= delta(tauxByVertex(direction, v0, dir0),
-               tauxByVertex(direction, v1, dir1));
-    // relabel site auxiliary indices
-    t *= p_cluster->DContract(v0, dir0, v1, dir1);
-    t *=
-      prime(p_cluster->DContract(v0, dir0, v1, dir1), p_cluster->BRAKET_OFFSET);
-  };
-
-  auto edgeIndices = [this](CtmEnv::DIRECTION direction, Vertex const& v,
-                            int dir) {
-    std::vector<Index> tmp = p_cluster->AIBraKetPair(v, dir);
-    tmp.emplace_back(tauxByVertex(direction, v, dir));
-    return tmp;
-  };
-
-  auto argsSVDRRt =
-    Args("Cutoff", -1.0, "Maxm", x, "SVDThreshold", 1E-2, "SVD_METHOD",
-         SVD_METHOD, "rsvd_power", rsvd_power, "rsvd_reortho", rsvd_reortho,
-         "rsvd_oversampling", rsvd_oversampling);
-
-  // Take the square-root of SV's
-  double loc_psdInvCutoff = isoPseudoInvCutoff;
+  std::vector<CtmMove> moves(1);
+  moves[0].direction = direction;
+  moves[0].iso_type = ISOMETRY_T3;
+  computeIsometries(moves, accT);
+  isometriesToMaps(moves[0], ip, ipt, P, Pt);
+}
 
-  // Corners to be used in construction of projectors
-  DIRECTION p_direction, pt_direction;
-  Shift shift;
-  CORNER corner_i, corner_it;
-  int dir0, dir1, p_dir, pt_dir;
-  switch (direction) {
-    case DIRECTION::LEFT: {
-      // P   v--------2 <--indices of U
-      //     3
-      //     1
-      // Pt  v+(0,1)--2
-      corner_i = CORNER::LU;
-      corner_it = CORNER::LD;
-      shift = Shift(0, 1);
-      dir0 = 3;
-      dir1 = 1;
-      p_direction = DIRECTION::UP;
-      pt_direction = DIRECTION::DOWN;
-      p_dir = 2;
-      break;
-    }
-    case DIRECTION::UP: {
-      // Pt              P
-      // v+(-1,0)--2 0---v
-      // |               |
-      // 3               3
-      //                 ^--indices of U
-      corner_i = CORNER::RU;
-      corner_it = CORNER::LU;
-      shift = Shift(-1, 0);
-      dir0 = 0;
-      dir1 = 2;
-      p_direction = DIRECTION::RIGHT;
-      pt_direction = DIRECTION::LEFT;
-      p_dir = 3;
-      break;
-    }
-    case DIRECTION::RIGHT: {
-      //                  0---v+(0,-1) Pt
-      //                      3
-      //                      1
-      // indices of U --> 0---v P
-      corner_i = CORNER::RD;
-      corner_it = CORNER::RU;
-      shift = Shift(0, -1);
-      dir0 = 1;
-      dir1 = 3;
-      p_direction = DIRECTION::DOWN;
-      pt_direction = DIRECTION::UP;
-      p_dir = 0;
-      break;
-    }
-    case DIRECTION::DOWN: {
-      // indices of U --V
-      //                1       1
-      //                |       |
-      //                v--2 0--v+(1,0)
-      //                P       Pt
-      corner_i = CORNER::LD;
-      corner_it = CORNER::RD;
-      shift = Shift(1, 0);
-      dir0 = 2;
-      dir1 = 0;
-      p_direction = DIRECTION::LEFT;
-      pt_direction = DIRECTION::RIGHT;
-      p_dir = 1;
-      break;
-    }
-  }
+void CtmEnv::compute_IsometriesT4(DIRECTION direction,
+                                  std::map<std::string, Index>& ip,
+                                  std::map<std::string, Index>& ipt,
+                                  std::map<std::string, ITensor>& P,
+                                  std::map<std::string, ITensor>& Pt,
+                                  std::vector<double>& accT) const {
+  std::vector<CtmMove> moves(1);
+  moves[0].direction = direction;
+  moves[0].iso_type = ISOMETRY_T4;
+  computeIsometries(moves, accT);
+  isometriesToMaps(moves[0], ip, ipt, P, Pt);
+}
 
-  time_point t_iso_begin, t_iso_end;
+void CtmEnv::isometriesToMaps(CtmMove const& m,
+                              std::map<std::string, Index>& ip,
+                              std::map<std::string, Index>& ipt,
+                              std::map<std::string, ITensor>& P,
+                              std::map<std::string, ITensor>& Pt) const {
+  ip.clear();
+  ipt.clear();
+  P.clear();
+  Pt.clear();
   for (auto const& id : p_cluster->siteIds) {
-    Vertex const& v = p_cluster->idToV.at(id);
-    Vertex v_shift = v + shift;
-
-    // std::cout<<"Computing 2x2 corner for: C"<< corner_i <<" : "<< v <<"="<<
-    // vToId(v); std::cout<<"Computing 2x2 corner for: C"<< corner_it <<" : "<<
-    // v+shift <<"="<< vToId(v+shift); Compute two halfs of 2x2 density matrix
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    ITensor U, S, V, R, Rt;
-    R = build_corner_V2(corner_i, v);
-    Rt = build_corner_V2(corner_it, v + shift);
-    // t_iso_end = std::chrono::high_resolution_clock::now();
-    // accT[4] += get_mS(t_iso_begin,t_iso_end);
-
-    auto cmb_p_inner = combiner(edgeIndices(direction, v, dir0));
-    auto cmb_pt_inner = combiner(edgeIndices(direction, v_shift, dir1));
-    // auto cmb_p_outer  = combiner(edgeIndices(p_direction,v,p_dir));
-    // auto cmb_pt_outer = combiner(edgeIndices(pt_direction,v_shift,p_dir));
-    R *= cmb_p_inner;
-    Rt *= cmb_pt_inner;
-    // R *= cmb_p_outer;
-    // Rt *= cmb_pt_outer;
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[4] += get_mS(t_iso_begin, t_iso_end);
-
-    // truncated SVD
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    // std::vector<Index> edge_p  = edgeIndices(direction,v,dir0);
-    // std::vector<Index> edge_pt = edgeIndices(direction,v_shift,dir1);
-
-    U = ITensor(edgeIndices(p_direction, v, p_dir));
-    // readyToContract(R,direction,v,dir0,v_shift,dir1);
-    // TODO use delta instead of reindex
-    // R *= delta( combinedIndex(cmb_p_inner), combinedIndex(cmb_pt_inner) );
-    // auto delta_R_Rt = delta( combinedIndex(cmb_p_inner),
-    // combinedIndex(cmb_pt_inner));
-    R = reindex(R, combinedIndex(cmb_p_inner), combinedIndex(cmb_pt_inner));
-    // CAUTION uncombined onsite AUXLINK indices must be distinguished in the
-    // case 1site invariant PEPS to prevent their contraction
-    Rt.prime(AUXLINK, tmp_prime_offset);
+    ip[id] = m.ip.at(id);
+    ipt[id] = m.ipt.at(id);
+    P[id] = m.P.at(id);
+    Pt[id] = m.Pt.at(id);
+  }
+}
 
-    svd(R * Rt, U, S, V, solver, argsSVDRRt);
-    if (S.real(S.inds().front()(1), S.inds().back()(1)) > isoMaxElemWarning ||
-        S.real(S.inds().front()(1), S.inds().back()(1)) < isoMinElemWarning) {
-      std::cout << "WARNING: CTM-Iso3 " << direction << " [col:row]= " << v
-                << " Max Sing. val.: "
-                << S.real(S.inds().front()(1), S.inds().back()(1)) << std::endl;
-    }
+// The projectors of individual sites are independent. Their index plumbing
+// is taken from the plan of the move (built serially, as itensor::Index id
+// generator is not thread-safe), the enlarged corners, SVDs and projectors
+// of all (move, site) pairs are computed concurrently into per-site results
+// which are merged into ip, ipt, P, Pt of each move afterwards
+void CtmEnv::computeIsometries(std::vector<CtmMove>& moves,
+                               std::vector<double>& accT) const {
+  int const nSites = p_cluster->siteIds.size();
+  int const nTasks = moves.size() * nSites;
+  for (auto& m : moves) {
+    if (!m.reuseIso)
+      prepareIsometries(m);
+  }
+  // bring the cache of double-layer tensors up to date before it is read
+  // concurrently by the per-site tasks of this and the absorption stage
+  if (!layeredContraction)
+    refreshBraKet();
+
+#ifdef PEPS_WITH_OPENMP
+#pragma omp parallel for num_threads(ctmThreads) schedule(dynamic, 1)
+#endif
+  for (int k = 0; k < nTasks; k++) {
+    auto& m = moves[k / nSites];
+    if (!m.reuseIso)
+      computeIsometry(m, k % nSites, m.iso[k % nSites]);
+  }
 
-    R = reindex(R, combinedIndex(cmb_pt_inner), combinedIndex(cmb_p_inner));
-    Rt.prime(AUXLINK, -tmp_prime_offset);
-    V.prime(AUXLINK, -tmp_prime_offset);
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[6] += get_mS(t_iso_begin, t_iso_end);
-
-    // Create pseudo-inverse matrix and compute projectors
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    auto sIU = commonIndex(U, S);
-    auto sIV = commonIndex(S, V);
-    int rank = std::max(sIU.m(), sIV.m());
-    double max_sv = S.real(S.inds().front()(1), S.inds().back()(1));
-    double est_tol = std::sqrt(max_sv * rank * machine_eps);
-    double arg_tol = std::sqrt(max_sv) * loc_psdInvCutoff;
-    // TODO expose debug setting here
-    // if ( dbg && (not default_pinv_cutoff) && (est_tol > arg_tol) )
-    // std::cout<<
-    // "[compute_IsometriesT4] WARNING: est_tol > loc_psdInvCutoff*max_sv"<<
-    // std::endl;
-    double tol = (default_pinv_cutoff) ? est_tol : arg_tol;
-    // auto oneOverSqrtT = [&tol](Real r)
-    //    	{ return (r > tol) ? 1.0/std::sqrt(r) : 0.0; };
-    // S.apply(oneOverSqrtT);
-
-    std::vector<double> invS_diag(rank, 0.0);
-    for (int is = 1; is <= rank; is++) {
-      auto elem = S.real(S.inds().front()(is), S.inds().back()(is));
-      if (elem > tol) {
-        invS_diag[is - 1] = 1.0 / std::sqrt(elem);
-      } else {
-        break;
+  // merge per-site results in the order of siteIds
+  for (auto& m : moves) {
+    if (m.reuseIso)
+      continue;
+    for (int i = 0; i < nSites; i++) {
+      auto const& p = m.plan->iso[i];
+      auto& r = m.iso[i];
+      if (r.max_sv > isoMaxElemWarning || r.max_sv < isoMinElemWarning) {
+        std::cout << "WARNING: CTM-Iso"
+                  << ((m.iso_type == ISOMETRY_T3) ? "3" : "4") << " "
+                  << m.direction << " [col:row]= " << p.v
+                  << " Max Sing. val.: " << r.max_sv << std::endl;
       }
+      m.ip[p.h] = p.ip;
+      m.ipt[p.h] = p.ipt;
+      m.P[p.h] = std::move(r.P);
+      m.Pt[p.h] = std::move(r.Pt);
+      if (solver.warmStart())
+        isoBasis[m.direction][p.id] = std::move(r.U);
+      accT[4] += r.accT[0];
+      accT[6] += r.accT[1];
+      accT[7] += r.accT[2];
     }
-    S = diagTensor(invS_diag, sIU, sIV);
-
-    // set innner indices back to original state
-    // readyToContract(R,direction,v,dir0,v_shift,dir1);
-    // R *= delta( combinedIndex(cmb_p_inner), combinedIndex(cmb_pt_inner) );
+  }
+}
 
-    ip[id] = Index("P_" + id, tauxByVertex(direction, v, dir0).m());
-    ipt[id] = Index("Pt_" + id, tauxByVertex(direction, v, dir1).m());
+// Projectors of all sites of a direction are reused together or not at
+// all. The gauge of the environment tensors on a given link is set by the
+// projectors of the previous move, possibly computed for a different site.
+// Mixing reused and fresh projectors would thus mix incompatible gauges
+bool CtmEnv::loadIsometries(CtmMove& m) {
+  auto& c = isoReuse[m.direction];
+  if (isoReuseTol <= 0.0 || !c.stable || c.iso_type != m.iso_type ||
+      c.siteVersion != p_cluster->siteVersion || c.reused >= isoReuseMax)
+    return false;
+
+  c.reused++;
+  isoSkipped += p_cluster->siteIds.size();
+  m.ip = c.ip;
+  m.ipt = c.ipt;
+  m.P = c.P;
+  m.Pt = c.Pt;
+  return true;
+}
 
-    // TODO use delta instead of reindex
-    // P[ id] = ((R* U.dag())*S)*delta(sIV, ip[id] );
-    // Pt[id] = ((Rt*V.dag())*S)*delta(sIU, ipt[id]);
-    P[id] = (R * U.dag()) * S;
-    Pt[id] = (Rt * V.dag()) * S;
-    P[id] = reindex(P[id], sIV, ip[id]);
-    Pt[id] = reindex(Pt[id], sIU, ipt[id]);
+void CtmEnv::storeIsometries(CtmMove const& m) {
+  spec.reused[m.direction] = m.reuseIso;
+  if (m.reuseIso)
+    return;
+  isoComputed += p_cluster->siteIds.size();
+
+  // record spectra of the corners
+  int const nSites = p_cluster->siteIds.size();
+  spec.sv[m.direction].resize(nSites);
+  for (int i = 0; i < nSites; i++)
+    spec.sv[m.direction][m.plan->iso[i].h] = m.iso[i].sv;
+
+  double truncErr = 0.0;
+  for (auto const& r : m.iso)
+    truncErr = std::max(truncErr, r.truncErr);
+  isoTruncErr[m.direction] = truncErr;
+  if (DBG)
+    std::cout << "CTM move " << m.direction << " x= " << x
+              << " truncErr: " << truncErr << std::endl;
+
+  if (isoReuseTol <= 0.0)
+    return;
+
+  // compare to the projectors applied by the last move in this direction,
+  // which define the gauge of the current environment
+  auto& c = isoReuse[m.direction];
+  bool comparable = (c.siteVersion == p_cluster->siteVersion) &&
+                    (c.iso_type == m.iso_type) && (c.P.size() == m.P.size());
+  double change = 0.0;
+  if (comparable) {
+    for (auto const& id : p_cluster->siteIds) {
+      auto dP = m.P.at(id) - reindex(c.P.at(id), c.ip.at(id), m.ip.at(id));
+      auto dPt =
+        m.Pt.at(id) - reindex(c.Pt.at(id), c.ipt.at(id), m.ipt.at(id));
+      change = std::max(change, norm(dP) / norm(m.P.at(id)));
+      change = std::max(change, norm(dPt) / norm(m.Pt.at(id)));
+    }
+  }
 
-    P[id] *= cmb_p_inner;
-    Pt[id] *= cmb_pt_inner;
+  c.iso_type = m.iso_type;
+  c.siteVersion = p_cluster->siteVersion;
+  c.stable = comparable && (change < isoReuseTol);
+  c.reused = 0;
+  c.ip = m.ip;
+  c.ipt = m.ipt;
+  c.P = m.P;
+  c.Pt = m.Pt;
+}
 
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[7] += get_mS(t_iso_begin, t_iso_end);
+void CtmEnv::prepareIsometries(CtmMove& m) const {
+  m.plan = &movePlan(m.direction);
+
+  int const nSites = p_cluster->siteIds.size();
+  m.iso = std::vector<IsoResult>(nSites);
+  m.ip = SiteIndexMap(C_LU.layout());
+  m.ipt = SiteIndexMap(C_LU.layout());
+  m.P = SiteTensorMap(C_LU.layout());
+  m.Pt = SiteTensorMap(C_LU.layout());
+  if (solver.warmStart()) {
+    for (int i = 0; i < nSites; i++) {
+      auto it = isoBasis[m.direction].find(m.plan->iso[i].id);
+      if (it != isoBasis[m.direction].end())
+        m.iso[i].U0 = it->second;
+    }
   }
 }
 
-void CtmEnv::compute_IsometriesT4(DIRECTION direction,
-                                  std::map<std::string, Index>& ip,
-                                  std::map<std::string, Index>& ipt,
-                                  std::map<std::string, ITensor>& P,
-                                  std::map<std::string, ITensor>& Pt,
-                                  std::vector<double>& accT) const {
+void CtmEnv::computeIsometry(CtmMove const& m, int i, IsoResult& r) const {
   using time_point = std::chrono::high_resolution_clock::time_point;
 
-  double const machine_eps = std::numeric_limits<double>::epsilon();
+  double const machine_eps =
+    lowPrecision ? std::numeric_limits<float>::epsilon()
+                 : std::numeric_limits<double>::epsilon();
   int const tmp_prime_offset = 100;
 
   auto get_mS = [](time_point ti, time_point tf) {
@@ -650,199 +794,139 @@ void CtmEnv::compute_IsometriesT4(DIRECTION direction,
            1000.0;
   };
 
-  auto vToId = [this](Vertex const& v) { return p_cluster->vertexToId(v); };
-
-  auto readyToContract = [this](ITensor& t, CtmEnv::DIRECTION direction,
-                                Vertex const& v0, int dir0, Vertex const& v1,
-                                int dir1) {
-    // relabel env auxiliary indices
-    t *= delta(tauxByVertex(direction, v0, dir0),
-               tauxByVertex(direction, v1, dir1));
-    // relabel site auxiliary indices
-    t *= p_cluster->DContract(v0, dir0, v1, dir1);
-    t *=
-      prime(p_cluster->DContract(v0, dir0, v1, dir1), p_cluster->BRAKET_OFFSET);
-  };
-
-  auto edgeIndices = [this](CtmEnv::DIRECTION direction, Vertex const& v,
-                            int dir) {
-    std::vector<Index> tmp = p_cluster->AIBraKetPair(v, dir);
-    tmp.emplace_back(tauxByVertex(direction, v, dir));
-    return tmp;
-  };
+  // in the reduced-accuracy phase iterative solvers stop early
+  double const svd_tol =
+    lowPrecision ? std::max(warmstart_tol, std::sqrt(machine_eps))
+                 : warmstart_tol;
+  int const svd_power = lowPrecision ? std::min(rsvd_power, 1) : rsvd_power;
 
   auto argsSVDRRt =
     Args("Cutoff", -1.0, "Maxm", x, "SVDThreshold", 1E-2, "SVD_METHOD",
-         SVD_METHOD, "rsvd_power", rsvd_power, "rsvd_reortho", rsvd_reortho,
-         "rsvd_oversampling", rsvd_oversampling, "dbg", false);
+         SVD_METHOD, "rsvd_power", svd_power, "rsvd_reortho", rsvd_reortho,
+         "rsvd_oversampling", rsvd_oversampling, "warmstart_iter",
+         warmstart_iter, "warmstart_tol", svd_tol, "auto_svd_cache",
+         autoSvdCache, "dbg", false);
 
   // Take the square-root of SV's
   double loc_psdInvCutoff = isoPseudoInvCutoff;
 
-  // Corners to be used in construction of projectors
-  DIRECTION opposite_direction;
-  Shift shift, shift_oi;
-  int dir0, dir1;
-  switch (direction) {
-    case DIRECTION::LEFT: {
-      // P   v--------v+(1,0)
-      //     3        3 <-- indices of U
-      //     1        1
-      // Pt  v+(0,1)--v+(1,1)
-      opposite_direction = DIRECTION::RIGHT;
-      shift = Shift(0, 1);
-      shift_oi = Shift(1, 0);
-      dir0 = 3;
-      dir1 = 1;
-      break;
-    }
-    case DIRECTION::UP: {
-      // Pt              P
-      // v+(-1,0)--2 0---v
-      // |               |
-      // v+(-1,1)--2 0---v+(0,1)
-      //             ^--indices of U
-      opposite_direction = DIRECTION::DOWN;
-      shift = Shift(-1, 0);
-      shift_oi = Shift(0, 1);
-      dir0 = 0;
-      dir1 = 2;
-      break;
-    }
-    case DIRECTION::RIGHT: {
-      //                  v+(-1,-1)--v+(0,-1) Pt
-      //                  3          3
-      // indices of U --> 1          1
-      //                  v+(-1,0)---v        P
-      opposite_direction = DIRECTION::LEFT;
-      shift = Shift(0, -1);
-      shift_oi = Shift(-1, 0);
-      dir0 = 1;
-      dir1 = 3;
-      break;
-    }
-    case DIRECTION::DOWN: {
-      // indices of U --V
-      //      v+(0,-1)--2 0--v+(1,-1)
-      //      |              |
-      //      v---------2 0--v+(1,0)
-      //      P              Pt
-      opposite_direction = DIRECTION::UP;
-      shift = Shift(1, 0);
-      shift_oi = Shift(0, -1);
-      dir0 = 2;
-      dir1 = 0;
-      break;
-    }
-  }
-
+  auto const& p = m.plan->iso[i];
   time_point t_iso_begin, t_iso_end;
-  for (auto const& id : p_cluster->siteIds) {
-    Vertex const& v = p_cluster->idToV.at(id);
-    Vertex v_shift = v + shift;
-    Vertex v_shift_oi = v + shift_oi;
-
-    // Compute two halfs of 2x2 density matrix
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    ITensor U, S, V, R, Rt;
-    build_halves_V2(direction, v, R, Rt);
-    auto cmb_p_inner = combiner(edgeIndices(direction, v, dir0));
-    auto cmb_pt_inner = combiner(edgeIndices(direction, v_shift, dir1));
-    R *= cmb_p_inner;
-    Rt *= cmb_pt_inner;
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[4] += get_mS(t_iso_begin, t_iso_end);
-
-    // truncated SVD
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    U = prime(ITensor(edgeIndices(opposite_direction, v_shift_oi, dir0)),
-              AUXLINK, tmp_prime_offset);
-    // readyToContract(R,direction,v,dir0,v_shift,dir1);
-    // TODO use delta instead of reindex
-    R = reindex(R, combinedIndex(cmb_p_inner), combinedIndex(cmb_pt_inner));
-
-    svd(R * Rt, U, S, V, solver, argsSVDRRt);
-    if (S.real(S.inds().front()(1), S.inds().back()(1)) > isoMaxElemWarning ||
-        S.real(S.inds().front()(1), S.inds().back()(1)) < isoMinElemWarning) {
-      std::cout << "WARNING: CTM-Iso4 " << direction << " [col:row]= " << v
-                << " Max Sing. val.: "
-                << S.real(S.inds().front()(1), S.inds().back()(1)) << std::endl;
-    }
-
-    R = reindex(R, combinedIndex(cmb_pt_inner), combinedIndex(cmb_p_inner));
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[6] += get_mS(t_iso_begin, t_iso_end);
-
-    // Create pseudo-inverse matrix and compute projectors
-    t_iso_begin = std::chrono::high_resolution_clock::now();
-    auto sIU = commonIndex(U, S);
-    auto sIV = commonIndex(S, V);
-    int rank = std::max(sIU.m(), sIV.m());
-    double max_sv = S.real(S.inds().front()(1), S.inds().back()(1));
-    double est_tol = std::sqrt(max_sv * rank * machine_eps);
-    double arg_tol = std::sqrt(max_sv) * loc_psdInvCutoff;
-    // TODO expose debug setting here
-    // if ( dbg && (not default_pinv_cutoff) && (est_tol > arg_tol) )
-    // std::cout<<
-    // "[compute_IsometriesT4] WARNING: est_tol > loc_psdInvCutoff*max_sv"<<
-    // std::endl;
-    double tol = (default_pinv_cutoff) ? est_tol : arg_tol;
-    // auto oneOverSqrtT = [&tol](Real r)
-    //    	{ return (r > tol) ? 1.0/sqrt(r) : 0.0; };
-    // S.apply(oneOverSqrtT);
-
-    std::vector<double> invS_diag(rank, 0.0);
-    for (int is = 1; is <= rank; is++) {
-      auto elem = S.real(S.inds().front()(is), S.inds().back()(is));
-      if (elem > tol) {
-        invS_diag[is - 1] = 1.0 / std::sqrt(elem);
-      } else {
-        break;
-      }
-    }
-    S = diagTensor(invS_diag, sIU, sIV);
 
-    // set innner indices back to original state
-    // readyToContract(R,direction,v,dir0,v_shift,dir1);
+  // randomized solvers draw their samples from a generator seeded per site
+  // and direction, independent of the thread running this task
+  argsSVDRRt.add("svd_seed", 1234 + 4 * p.h + int(m.direction));
 
-    ip[id] = Index("P_" + id, tauxByVertex(direction, v, dir0).m());
-    ipt[id] = Index("Pt_" + id, tauxByVertex(direction, v, dir1).m());
+  // Compute two halfs of 2x2 density matrix. Inner indices of R are
+  // combined directly into the combined index of Rt
+  t_iso_begin = std::chrono::high_resolution_clock::now();
+  ITensor U, S, V, R, Rt;
+  if (m.iso_type == ISOMETRY_T3) {
+    R = build_corner_V2(m.plan->corner_i, p.v);
+    Rt = build_corner_V2(m.plan->corner_it, p.v_shift);
+  } else {
+    build_halves_V2(m.direction, p.v, p.cmb_halves, R, Rt);
+  }
+  R *= p.cmb_p_inner_r;
+  Rt *= p.cmb_pt_inner;
+  t_iso_end = std::chrono::high_resolution_clock::now();
+  r.accT[0] = get_mS(t_iso_begin, t_iso_end);
 
-    // TODO use delta instead of reindex
-    // P[ id] = ((R* U.dag())*S)*delta(sIV, ip[id] );
-    // Pt[id] = ((Rt*V.dag())*S)*delta(sIU, ipt[id]);
-    P[id] = (R * U.dag()) * S;
-    Pt[id] = (Rt * V.dag()) * S;
-    P[id] = reindex(P[id], sIV, ip[id]);
-    Pt[id] = reindex(Pt[id], sIU, ipt[id]);
+  // truncated SVD
+  t_iso_begin = std::chrono::high_resolution_clock::now();
+  U = (m.iso_type == ISOMETRY_T3) ? p.U_T3 : p.U_T4;
+  // CAUTION uncombined onsite AUXLINK indices must be distinguished in the
+  // case 1site invariant PEPS to prevent their contraction
+  if (m.iso_type == ISOMETRY_T3)
+    Rt.prime(AUXLINK, tmp_prime_offset);
 
-    P[id] *= cmb_p_inner;
-    Pt[id] *= cmb_pt_inner;
+  auto RRt = R * Rt;
+  svd(RRt, U, S, V, r.U0, solver, argsSVDRRt);
+  // discarded weight relative to the Frobenius norm of R*Rt. Unlike the
+  // truncation error reported by svd, it does not rely on the solver
+  // returning the discarded tail of the spectrum (rsvd, warm-start,
+  // lanczos compute only the leading part)
+  r.truncErr = std::max(0.0, 1.0 - std::pow(norm(S) / norm(RRt), 2));
+  r.max_sv = S.real(S.inds().front()(1), S.inds().back()(1));
+  if (solver.warmStart())
+    r.U = U;
+
+  if (m.iso_type == ISOMETRY_T3) {
+    Rt.prime(AUXLINK, -tmp_prime_offset);
+    V.prime(AUXLINK, -tmp_prime_offset);
+  }
+  t_iso_end = std::chrono::high_resolution_clock::now();
+  r.accT[1] = get_mS(t_iso_begin, t_iso_end);
 
-    t_iso_end = std::chrono::high_resolution_clock::now();
-    accT[7] += get_mS(t_iso_begin, t_iso_end);
+  // Create pseudo-inverse matrix and compute projectors
+  t_iso_begin = std::chrono::high_resolution_clock::now();
+  auto sIU = commonIndex(U, S);
+  auto sIV = commonIndex(S, V);
+  int rank = std::max(sIU.m(), sIV.m());
+  double max_sv = r.max_sv;
+  r.sv = std::vector<double>(sIU.m());
+  for (int is = 1; is <= sIU.m(); is++)
+    r.sv[is - 1] = S.real(S.inds().front()(is), S.inds().back()(is)) / max_sv;
+  double est_tol = std::sqrt(max_sv * rank * machine_eps);
+  double arg_tol = std::sqrt(max_sv) * loc_psdInvCutoff;
+  // TODO expose debug setting here
+  // if ( dbg && (not default_pinv_cutoff) && (est_tol > arg_tol) )
+  // std::cout<<
+  // "[compute_IsometriesT4] WARNING: est_tol > loc_psdInvCutoff*max_sv"<<
+  // std::endl;
+  double tol = (default_pinv_cutoff) ? est_tol : arg_tol;
+  if (lowPrecision)
+    tol = std::max(tol, est_tol);
+
+  std::vector<double> invS_diag(rank, 0.0);
+  for (int is = 1; is <= rank; is++) {
+    auto elem = S.real(S.inds().front()(is), S.inds().back()(is));
+    if (elem > tol) {
+      invS_diag[is - 1] = 1.0 / std::sqrt(elem);
+    } else {
+      break;
+    }
+  }
+  if (isoFixGauge) {
+    // flip the singular vectors (U, V pairwise) with negative overlap with
+    // a fixed random vector. Without it, the gauge of new environment
+    // indices is arbitrary up to signs in every iteration
+    auto w = U * ((m.iso_type == ISOMETRY_T3) ? p.gauge_T3 : p.gauge_T4);
+    for (int is = 1; is <= sIU.m(); is++)
+      if (w.cplx(sIU(is)).real() < 0.0)
+        invS_diag[is - 1] *= -1.0;
   }
+
+  // P[ id] = ((R* U.dag())*S)*delta(sIV, ip[id] );
+  // Pt[id] = ((Rt*V.dag())*S)*delta(sIU, ipt[id]);
+  // where the relabelling is folded into the pseudo-inverse
+  r.P = (R * U.dag()) * diagTensor(invS_diag, sIU, p.ip);
+  r.Pt = (Rt * V.dag()) * diagTensor(invS_diag, sIV, p.ipt);
+
+  // uncombine inner indices
+  r.P *= p.cmb_p_inner_r;
+  r.Pt *= p.cmb_pt_inner;
+
+  t_iso_end = std::chrono::high_resolution_clock::now();
+  r.accT[2] = get_mS(t_iso_begin, t_iso_end);
 }
 
 ITensor CtmEnv::build_corner_V2(CORNER cornerType, Vertex const& v) const {
-  auto BRAKET_OFFSET = p_cluster->BRAKET_OFFSET;
-  auto sites = p_cluster->sites;
-
   std::string siteId = p_cluster->vertexToId(v);
+  int const h = siteHandle(siteId);
 
   ITensor ct;
   switch (cornerType) {
     case CORNER::LU: {
       // build left upper corner
-      ct = C_LU.at(siteId) * T_L.at(siteId);
-      ct *= T_U.at(siteId);
+      ct = C_LU[h] * T_L[h];
+      ct *= T_U[h];
       // auto cmb_tmp = combiner(p_cluster->AIc(siteId,0),
       // 	prime(p_cluster->AIc(siteId,0), p_cluster->BRAKET_OFFSET),
       // 	p_cluster->AIc(siteId,1),
       // 	prime(p_cluster->AIc(siteId,1), p_cluster->BRAKET_OFFSET) );
       // ct *= cmb_tmp;
-      ct *= (sites.at(siteId) *
-             dag(prime(sites.at(siteId), AUXLINK, BRAKET_OFFSET)));
+      absorbSiteBraKet(ct, siteId);
       // auto tmp_site = (sites.at(siteId) *
       // dag(prime(sites.at(siteId),AUXLINK,BRAKET_OFFSET))); tmp_site *=
       // cmb_tmp; ct *= tmp_site;
@@ -850,15 +934,14 @@ ITensor CtmEnv::build_corner_V2(CORNER cornerType, Vertex const& v) const {
     }
     case CORNER::RU: {
       // build right upper corner
-      ct = C_RU.at(siteId) * T_U.at(siteId);
-      ct *= T_R.at(siteId);
+      ct = C_RU[h] * T_U[h];
+      ct *= T_R[h];
       // auto cmb_tmp = combiner(p_cluster->AIc(siteId,1),
       // 	prime(p_cluster->AIc(siteId,1), p_cluster->BRAKET_OFFSET),
       // 	p_cluster->AIc(siteId,2),
       // 	prime(p_cluster->AIc(siteId,2), p_cluster->BRAKET_OFFSET) );
       // ct *= cmb_tmp;
-      ct *= (sites.at(siteId) *
-             dag(prime(sites.at(siteId), AUXLINK, BRAKET_OFFSET)));
+      absorbSiteBraKet(ct, siteId);
       // auto tmp_site = (sites.at(siteId) *
       // dag(prime(sites.at(siteId),AUXLINK,BRAKET_OFFSET))); tmp_site *=
       // cmb_tmp; ct *= tmp_site;
@@ -866,15 +949,14 @@ ITensor CtmEnv::build_corner_V2(CORNER cornerType, Vertex const& v) const {
     }
     case CORNER::RD: {
       // build right lower corner
-      ct = C_RD.at(siteId) * T_R.at(siteId);
-      ct *= T_D.at(siteId);
+      ct = C_RD[h] * T_R[h];
+      ct *= T_D[h];
       // auto cmb_tmp = combiner(p_cluster->AIc(siteId,2),
       // 	prime(p_cluster->AIc(siteId,2), p_cluster->BRAKET_OFFSET),
       // 	p_cluster->AIc(siteId,3),
       // 	prime(p_cluster->AIc(siteId,3), p_cluster->BRAKET_OFFSET) );
       // ct *= cmb_tmp;
-      ct *= (sites.at(siteId) *
-             dag(prime(sites.at(siteId), AUXLINK, BRAKET_OFFSET)));
+      absorbSiteBraKet(ct, siteId);
       // auto tmp_site = (sites.at(siteId) *
       // dag(prime(sites.at(siteId),AUXLINK,BRAKET_OFFSET))); tmp_site *=
       // cmb_tmp; ct *= tmp_site;
@@ -882,15 +964,14 @@ ITensor CtmEnv::build_corner_V2(CORNER cornerType, Vertex const& v) const {
     }
     case CORNER::LD: {
       // build left lower corner
-      ct = C_LD.at(siteId) * T_D.at(siteId);
-      ct *= T_L.at(siteId);
+      ct = C_LD[h] * T_D[h];
+      ct *= T_L[h];
       // auto cmb_tmp = combiner(p_cluster->AIc(siteId,3),
       // 	prime(p_cluster->AIc(siteId,3), p_cluster->BRAKET_OFFSET),
       // 	p_cluster->AIc(siteId,0),
       // 	prime(p_cluster->AIc(siteId,0), p_cluster->BRAKET_OFFSET) );
       // ct *= cmb_tmp;
-      ct *=
-        sites.at(siteId) * dag(prime(sites.at(siteId), AUXLINK, BRAKET_OFFSET));
+      absorbSiteBraKet(ct, siteId);
       // auto tmp_site = (sites.at(siteId) *
       // dag(prime(sites.at(siteId),AUXLINK,BRAKET_OFFSET))); tmp_site *=
       // cmb_tmp; ct *= tmp_site;
@@ -900,125 +981,276 @@ ITensor CtmEnv::build_corner_V2(CORNER cornerType, Vertex const& v) const {
   return ct;
 }
 
+std::array<ITensor, 4> CtmEnv::build_halves_combiners(
+  DIRECTION direction,
+  Vertex const& v) const {
+  auto edgeCombiner = [this](DIRECTION direction, Vertex const& v,
+                             int dir) {
+    return combiner(tauxByVertex(direction, v, dir), p_cluster->AIc(v, dir),
+                    prime(p_cluster->AIc(v, dir), p_cluster->BRAKET_OFFSET));
+  };
+
+  // for each half, the edge of the first corner is joined to the edge
+  // of the second one (see build_halves_V2)
+  switch (direction) {
+    case DIRECTION::LEFT:
+      return {{edgeCombiner(DIRECTION::UP, v, 2),
+               edgeCombiner(DIRECTION::UP, v + Shift(1, 0), 0),
+               edgeCombiner(DIRECTION::DOWN, v + Shift(0, 1), 2),
+               edgeCombiner(DIRECTION::DOWN, v + Shift(1, 1), 0)}};
+    case DIRECTION::UP:
+      return {{edgeCombiner(DIRECTION::RIGHT, v, 3),
+               edgeCombiner(DIRECTION::RIGHT, v + Shift(0, 1), 1),
+               edgeCombiner(DIRECTION::LEFT, v + Shift(-1, 0), 3),
+               edgeCombiner(DIRECTION::LEFT, v + Shift(-1, 1), 1)}};
+    case DIRECTION::RIGHT:
+      return {{edgeCombiner(DIRECTION::DOWN, v, 0),
+               edgeCombiner(DIRECTION::DOWN, v + Shift(-1, 0), 2),
+               edgeCombiner(DIRECTION::UP, v + Shift(0, -1), 0),
+               edgeCombiner(DIRECTION::UP, v + Shift(-1, -1), 2)}};
+    case DIRECTION::DOWN:
+      return {{edgeCombiner(DIRECTION::LEFT, v, 1),
+               edgeCombiner(DIRECTION::LEFT, v + Shift(0, -1), 3),
+               edgeCombiner(DIRECTION::RIGHT, v + Shift(1, 0), 1),
+               edgeCombiner(DIRECTION::RIGHT, v + Shift(1, -1), 3)}};
+    default:
+      throw std::runtime_error("[build_halves_combiners] Invalid direction");
+  }
+}
+
 // TODO how to handle a case of 1site invariant wavefunction
+//
+// Edge combiners cmb are given by build_halves_combiners. They are taken
+// from the plan of the move, since this method is called concurrently
+// for different sites
 void CtmEnv::build_halves_V2(DIRECTION direction,
                              Vertex const& v,
+                             std::array<ITensor, 4> const& cmb,
                              ITensor& H,
                              ITensor& Ht) const {
   int const tmp_prime_offset = 100;
-  auto readyToContract = [this](ITensor& t, DIRECTION direction,
-                                Vertex const& v0, int dir0, Vertex const& v1,
-                                int dir1) {
-    // relabel env auxiliary indices
-    t *= delta(tauxByVertex(direction, v0, dir0),
-               tauxByVertex(direction, v1, dir1));
-    // relabel site auxiliary indices
-    t *= p_cluster->DContract(v0, dir0, v1, dir1);
-    t *=
-      prime(p_cluster->DContract(v0, dir0, v1, dir1), p_cluster->BRAKET_OFFSET);
-  };
-
-  auto getEdgeCombiners = [this](ITensor& cmb_v0, ITensor& cmb_v1,
-                                 DIRECTION direction, Vertex const& v0,
-                                 int dir0, Vertex const& v1, int dir1) {
-    cmb_v0 =
-      combiner(tauxByVertex(direction, v0, dir0), p_cluster->AIc(v0, dir0),
-               prime(p_cluster->AIc(v0, dir0), p_cluster->BRAKET_OFFSET));
-    cmb_v1 =
-      combiner(tauxByVertex(direction, v1, dir1), p_cluster->AIc(v1, dir1),
-               prime(p_cluster->AIc(v1, dir1), p_cluster->BRAKET_OFFSET));
-  };
 
-  // TODO use delta instead of reindex for relabeling combined indices
-  ITensor cmb0, cmb1;
+  // corners of H (first two) and Ht (last two)
+  std::array<CORNER, 4> corners;
+  std::array<Shift, 4> shifts;
   switch (direction) {
     case DIRECTION::LEFT: {  // left
-      std::vector<Vertex> vs(
-        {v, v + Shift(1, 0), v + Shift(0, 1), v + Shift(1, 1)});
-
-      // build upper half
-      H = build_corner_V2(CORNER::LU, vs[0]);  // LU
-      // readyToContract(H,DIRECTION::UP,vs[0],2,vs[1],0);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::UP, vs[0], 2, vs[1], 0);
-      H *= cmb0;
-      H = reindex(H, combinedIndex(cmb0), combinedIndex(cmb1));
-      H *= prime(build_corner_V2(CORNER::RU, vs[1]) * cmb1, AUXLINK,
-                 tmp_prime_offset);  // RU
-      // build lower half
-      Ht = build_corner_V2(CORNER::LD, vs[2]);  // LD
-      // readyToContract(Ht,DIRECTION::DOWN,vs[2],2,vs[3],0);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::DOWN, vs[2], 2, vs[3], 0);
-      Ht *= cmb0;
-      Ht = reindex(Ht, combinedIndex(cmb0), combinedIndex(cmb1));
-      Ht *= prime(build_corner_V2(CORNER::RD, vs[3]) * cmb1, AUXLINK,
-                  tmp_prime_offset);  // RD
+      // upper half LU-RU, lower half LD-RD
+      corners = {{CORNER::LU, CORNER::RU, CORNER::LD, CORNER::RD}};
+      shifts = {{Shift(0, 0), Shift(1, 0), Shift(0, 1), Shift(1, 1)}};
       break;
     }
     case DIRECTION::UP: {  // up
-      std::vector<Vertex> vs(
-        {v, v + Shift(0, 1), v + Shift(-1, 0), v + Shift(-1, 1)});
-
-      // build right half
-      H = build_corner_V2(CORNER::RU, vs[0]);  // RU
-      // readyToContract(H,DIRECTION::RIGHT,vs[0],3,vs[1],1);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::RIGHT, vs[0], 3, vs[1], 1);
-      H *= cmb0;
-      H = reindex(H, combinedIndex(cmb0), combinedIndex(cmb1));
-      H *= prime(build_corner_V2(CORNER::RD, vs[1]) * cmb1, AUXLINK,
-                 tmp_prime_offset);  // RD
-      // build left half (upper_h)
-      Ht = build_corner_V2(CORNER::LU, vs[2]);  // LU
-      // readyToContract(Ht,DIRECTION::LEFT,vs[2],3,vs[3],1);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::LEFT, vs[2], 3, vs[3], 1);
-      Ht *= cmb0;
-      Ht = reindex(Ht, combinedIndex(cmb0), combinedIndex(cmb1));
-      Ht *= prime(build_corner_V2(CORNER::LD, vs[3]) * cmb1, AUXLINK,
-                  tmp_prime_offset);  // LD
+      // right half RU-RD, left half LU-LD
+      corners = {{CORNER::RU, CORNER::RD, CORNER::LU, CORNER::LD}};
+      shifts = {{Shift(0, 0), Shift(0, 1), Shift(-1, 0), Shift(-1, 1)}};
       break;
     }
     case DIRECTION::RIGHT: {  // right
-      std::vector<Vertex> vs(
-        {v, v + Shift(-1, 0), v + Shift(0, -1), v + Shift(-1, -1)});
-
-      // build lower half
-      H = build_corner_V2(CORNER::RD, vs[0]);  // RD
-      // readyToContract(H,DIRECTION::DOWN,vs[0],0,vs[1],2);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::DOWN, vs[0], 0, vs[1], 2);
-      H *= cmb0;
-      H = reindex(H, combinedIndex(cmb0), combinedIndex(cmb1));
-      H *= prime(build_corner_V2(CORNER::LD, vs[1]) * cmb1, AUXLINK,
-                 tmp_prime_offset);  // LD
-      // build upper half
-      Ht = build_corner_V2(CORNER::RU, vs[2]);  // RU
-      // readyToContract(Ht,DIRECTION::UP,vs[2],0,vs[3],2);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::UP, vs[2], 0, vs[3], 2);
-      Ht *= cmb0;
-      Ht = reindex(Ht, combinedIndex(cmb0), combinedIndex(cmb1));
-      Ht *= prime(build_corner_V2(CORNER::LU, vs[3]) * cmb1, AUXLINK,
-                  tmp_prime_offset);  // LU
+      // lower half RD-LD, upper half RU-LU
+      corners = {{CORNER::RD, CORNER::LD, CORNER::RU, CORNER::LU}};
+      shifts = {{Shift(0, 0), Shift(-1, 0), Shift(0, -1), Shift(-1, -1)}};
       break;
     }
     case DIRECTION::DOWN: {  // down
-      std::vector<Vertex> vs(
-        {v, v + Shift(0, -1), v + Shift(1, 0), v + Shift(1, -1)});
-
-      // build left half
-      H = build_corner_V2(CORNER::LD, vs[0]);  // LD
-      // readyToContract(H,DIRECTION::LEFT,vs[0],1,vs[1],3);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::LEFT, vs[0], 1, vs[1], 3);
-      H *= cmb0;
-      H = reindex(H, combinedIndex(cmb0), combinedIndex(cmb1));
-      H *= prime(build_corner_V2(CORNER::LU, vs[1]) * cmb1, AUXLINK,
-                 tmp_prime_offset);  // LU
-      // build right half
-      Ht = build_corner_V2(CORNER::RD, vs[2]);  // RD
-      // readyToContract(Ht,DIRECTION::RIGHT,vs[2],1,vs[3],3);
-      getEdgeCombiners(cmb0, cmb1, DIRECTION::RIGHT, vs[2], 1, vs[3], 3);
-      Ht *= cmb0;
-      Ht = reindex(Ht, combinedIndex(cmb0), combinedIndex(cmb1));
-      Ht *= prime(build_corner_V2(CORNER::RU, vs[3]) * cmb1, AUXLINK,
-                  tmp_prime_offset);  // RU
+      // left half LD-LU, right half RD-RU
+      corners = {{CORNER::LD, CORNER::LU, CORNER::RD, CORNER::RU}};
+      shifts = {{Shift(0, 0), Shift(0, -1), Shift(1, 0), Shift(1, -1)}};
       break;
     }
+    default:
+      throw std::runtime_error("[build_halves_V2] Invalid direction");
+  }
+
+  auto half = [&](int k) {
+    auto t = build_corner_V2(corners[k], v + shifts[k]);
+    t *= cmb[k];
+    t = reindex(t, combinedIndex(cmb[k]), combinedIndex(cmb[k + 1]));
+    t *= prime(build_corner_V2(corners[k + 1], v + shifts[k + 1]) *
+                 cmb[k + 1],
+               AUXLINK, tmp_prime_offset);
+    return t;
+  };
+  H = half(0);
+  Ht = half(2);
+}
+
+std::vector<ITensor> CtmEnv::envTensors() const {
+  std::vector<ITensor> ts;
+  int const nSites = p_cluster->siteIds.size();
+  ts.reserve(8 * nSites);
+  for (int h = 0; h < nSites; h++) {
+    for (auto const* e : {&C_LU, &C_RU, &C_RD, &C_LD})
+      ts.push_back((*e)[h]);
+    for (auto const* e : {&T_U, &T_R, &T_D, &T_L})
+      ts.push_back((*e)[h]);
+  }
+  return ts;
+}
+
+void CtmEnv::setEnvTensors(std::vector<ITensor> const& ts) {
+  int const nSites = p_cluster->siteIds.size();
+  if (static_cast<int>(ts.size()) != 8 * nSites)
+    throw std::runtime_error("[setEnvTensors] Invalid number of tensors");
+
+  int k = 0;
+  for (int h = 0; h < nSites; h++) {
+    for (auto* e : {&C_LU, &C_RU, &C_RD, &C_LD})
+      (*e)[h] = ts[k++];
+    for (auto* e : {&T_U, &T_R, &T_D, &T_L})
+      (*e)[h] = ts[k++];
+  }
+}
+
+namespace {
+
+  // real part of the inner product of environments a and b
+  double envDot(std::vector<ITensor> const& a, std::vector<ITensor> const& b) {
+    double res = 0.0;
+    for (std::size_t i = 0; i < a.size(); i++)
+      res += (dag(a[i]) * b[i]).cplx().real();
+    return res;
+  }
+
+  // y += alpha * x
+  void envAxpy(std::vector<ITensor>& y,
+               double alpha,
+               std::vector<ITensor> const& x) {
+    for (std::size_t i = 0; i < y.size(); i++)
+      y[i] += alpha * x[i];
+  }
+
+  // solve A x = b for symmetric positive definite n x n matrix A (row major)
+  // by Cholesky decomposition. Solution is returned in b
+  bool solveSPD(std::vector<double> A, std::vector<double>& b, int n) {
+    for (int j = 0; j < n; j++) {
+      double d = A[j * n + j];
+      for (int k = 0; k < j; k++)
+        d -= A[j * n + k] * A[j * n + k];
+      if (!(d > 0.0))
+        return false;
+      A[j * n + j] = std::sqrt(d);
+      for (int i = j + 1; i < n; i++) {
+        double s = A[i * n + j];
+        for (int k = 0; k < j; k++)
+          s -= A[i * n + k] * A[j * n + k];
+        A[i * n + j] = s / A[j * n + j];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < i; k++)
+        b[i] -= A[i * n + k] * b[k];
+      b[i] /= A[i * n + i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      for (int k = i + 1; k < n; k++)
+        b[i] -= A[k * n + i] * b[k];
+      b[i] /= A[i * n + i];
+    }
+    for (auto const& e : b)
+      if (!std::isfinite(e))
+        return false;
+    return true;
+  }
+
+}  // namespace
+
+void CtmEnv::resetExtrapolation() { anderson = CtmAnderson(); }
+
+// Anderson mixing (type II) of environment x with its image f = F(x) under
+// the CTM sweep, residual r = f - x:
+//
+//   x_new = x + b*r - sum_j g_j (dx_j + b*dr_j)
+//
+// where dx_j, dr_j are differences of inputs and residuals of consecutive
+// iterations, b = andersonMixing and g minimizes |r - sum_j g_j dr_j|
+//
+double CtmEnv::extrapolate() {
+  if (anderson.siteVersion != p_cluster->siteVersion)
+    resetExtrapolation();
+
+  auto& a = anderson;
+  auto f = envTensors();
+  if (a.x.empty()) {
+    a.siteVersion = p_cluster->siteVersion;
+    a.x = f;
+    return -1.0;
+  }
+
+  auto r = f;
+  envAxpy(r, -1.0, a.x);
+  double res = std::sqrt(envDot(r, r) / envDot(f, f));
+  a.residuals.push_back(res);
+
+  auto restart = [&a, &f]() {
+    a.dx.clear();
+    a.dr.clear();
+    a.x_prev.clear();
+    a.r_prev.clear();
+    a.x = f;
+    a.restarts++;
+  };
+
+  if (andersonDepth <= 0) {
+    a.x = f;
+    return res;
+  }
+
+  // safeguard against divergence: continue by plain CTM iterations
+  if (a.minResidual >= 0.0 && res > andersonRestart * a.minResidual) {
+    restart();
+    setEnvTensors(f);
+    a.minResidual = res;
+    return res;
+  }
+  a.minResidual = (a.minResidual < 0.0) ? res : std::min(a.minResidual, res);
+
+  if (!a.x_prev.empty()) {
+    auto dx = a.x;
+    envAxpy(dx, -1.0, a.x_prev);
+    auto dr = r;
+    envAxpy(dr, -1.0, a.r_prev);
+    a.dx.push_back(std::move(dx));
+    a.dr.push_back(std::move(dr));
+    if (static_cast<int>(a.dr.size()) > andersonDepth) {
+      a.dx.erase(a.dx.begin());
+      a.dr.erase(a.dr.begin());
+    }
+  }
+  a.x_prev = a.x;
+  a.r_prev = r;
+
+  double const b = andersonMixing;
+  auto xn = a.x;
+  envAxpy(xn, b, r);
+
+  int const n = a.dr.size();
+  if (n > 0) {
+    // regularized normal equations of the least-squares problem for g
+    std::vector<double> G(n * n), g(n);
+    double maxDiag = 0.0;
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j <= i; j++)
+        G[i * n + j] = G[j * n + i] = envDot(a.dr[i], a.dr[j]);
+      g[i] = envDot(a.dr[i], r);
+      maxDiag = std::max(maxDiag, G[i * n + i]);
+    }
+    for (int i = 0; i < n; i++)
+      G[i * n + i] += andersonReg * maxDiag;
+
+    if (solveSPD(G, g, n)) {
+      for (int j = 0; j < n; j++) {
+        envAxpy(xn, -g[j], a.dx[j]);
+        envAxpy(xn, -b * g[j], a.dr[j]);
+      }
+    } else {
+      restart();
+      setEnvTensors(f);
+      return res;
+    }
   }
+
+  setEnvTensors(xn);
+  a.x = std::move(xn);
+  return res;
 }
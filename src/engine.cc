@@ -194,8 +194,10 @@ Args TrotterEngine<MPO_2site>::performSimpleUpdate(Cluster& cls,
     dirFromShift(td.tgates[gi].disp[0]),
     dirFromShift(-1 * td.tgates[gi].disp[0])};
 
-  return simpleUpdate(*td.tgates[gi].ptr_gate, cls, tmp_siteId_seq,
-                      tmp_auxIndsDir_seq, args);
+  auto diag = simpleUpdate(*td.tgates[gi].ptr_gate, cls, tmp_siteId_seq,
+                           tmp_auxIndsDir_seq, args);
+  cls.siteVersion++;
+  return diag;
   // NEW_INTERFACE return simpleUpdate(tgates[gi], args);
 }
 
@@ -234,8 +236,10 @@ Args TrotterEngine<MPO_3site>::performSimpleUpdate(Cluster& cls,
     dirFromShift(td.tgates[gi].disp[0]),
     dirFromShift(-1 * td.tgates[gi].disp[1])};
 
-  return simpleUpdate(*td.tgates[gi].ptr_gate, cls, tmp_siteId_seq,
-                      tmp_auxIndsDir_seq, args);
+  auto diag = simpleUpdate(*td.tgates[gi].ptr_gate, cls, tmp_siteId_seq,
+                           tmp_auxIndsDir_seq, args);
+  cls.siteVersion++;
+  return diag;
   // NEW_INTERFACE return simpleUpdate(tgates[gi], args);
 }
 
@@ -273,9 +277,11 @@ Args TrotterEngine<MPO_2site>::performFullUpdate(Cluster& cls,
     dirFromShift(td.tgates[gi].disp[0]),
     dirFromShift(-1 * td.tgates[gi].disp[0])};
 
-  return fullUpdate_ALS2S_IT(*td.tgates[gi].ptr_gate, cls, ctmEnv,
-                             tmp_siteId_seq, tmp_auxIndsDir_seq,
-                             *(this->pSolver), args);
+  auto diag = fullUpdate_ALS2S_IT(*td.tgates[gi].ptr_gate, cls, ctmEnv,
+                                  tmp_siteId_seq, tmp_auxIndsDir_seq,
+                                  *(this->pSolver), args);
+  cls.siteVersion++;
+  return diag;
   // NEW_INTERFACE return fullUpdate_ALS2S_IT(tgates[gi], cls, ctmEnv,
   // *(this->pSolver), args);
 
@@ -319,9 +325,11 @@ Args TrotterEngine<MPO_3site>::performFullUpdate(Cluster& cls,
     dirFromShift(td.tgates[gi].disp[0]),
     dirFromShift(-1 * td.tgates[gi].disp[1])};
 
-  return fullUpdate_ALS3S_IT(*td.tgates[gi].ptr_gate, cls, ctmEnv,
-                             tmp_siteId_seq, tmp_auxIndsDir_seq,
-                             *(this->pSolver), args);
+  auto diag = fullUpdate_ALS3S_IT(*td.tgates[gi].ptr_gate, cls, ctmEnv,
+                                  tmp_siteId_seq, tmp_auxIndsDir_seq,
+                                  *(this->pSolver), args);
+  cls.siteVersion++;
+  return diag;
   // NEW_INTERFACE return fullUpdate_ALS3S_IT(tgates[gi], cls, ctmEnv,
   // *(this->pSolver), args);
 }
@@ -368,8 +376,10 @@ Args TrotterEngine<OpNS>::performFullUpdate(Cluster& cls,
     dirFromShift(td.tgates[gi].disp[0]),
     dirFromShift(-1 * td.tgates[gi].disp[1])};
 
-  return fullUpdate_CG_full4S(*td.tgates[gi].ptr_gate, cls, ctmEnv,
-                              tmp_siteId_seq, tmp_auxIndsDir_seq, args);
+  auto diag = fullUpdate_CG_full4S(*td.tgates[gi].ptr_gate, cls, ctmEnv,
+                                   tmp_siteId_seq, tmp_auxIndsDir_seq, args);
+  cls.siteVersion++;
+  return diag;
   // NEW_INTERFACE return fullUpdate_CG_full4S(tgates[gi], cls, ctmEnv, args);
 
   // LEGACY return fullUpdate_ALS4S_LSCG_IT(*td.ptr_gateMPO[gi], cls, ctmEnv,
@@ -143,12 +143,12 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
 
     // prepare map from on-site tensor aux-indices to half row/column T
     // environment tensors
-    std::array<const std::map<std::string, ITensor>* const, 4> iToT(
+    std::array<const CtmEnv::SiteTensorMap* const, 4> iToT(
       {&ctmEnv.T_L, &ctmEnv.T_U, &ctmEnv.T_R, &ctmEnv.T_D});
 
     // prepare map from on-site tensor aux-indices pair to half corner T-C-T
     // environment tensors
-    const std::map<int, const std::map<std::string, ITensor>* const> iToC(
+    const std::map<int, const CtmEnv::SiteTensorMap* const> iToC(
       {{23, &ctmEnv.C_RD},
        {32, &ctmEnv.C_RD},
        {21, &ctmEnv.C_RU},
@@ -580,14 +580,24 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
     {
       ITensor M =
         (eRE * eB) * delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0]));
-      M *= (prime(conj(eB), AUXLINK, 4) *
-            prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4));
+      ITensor MR =
+        prime(conj(eB), AUXLINK, 4) *
+        prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4);
+      // matrix-free solvers apply M = (eRE * eB) * MR to eA as a sequence
+      // of contractions, without forming it
+      bool const matFree = ls.matrixFree();
+      if (!matFree)
+        M *= MR;
+      auto applyM = [&](ITensor const& x) {
+        return matFree ? (M * x) * MR : M * x;
+      };
+      auto MeA = applyM(eA);
 
       ITensor K = protoK * prime(conj(eB), AUXLINK, 4);
       K *= prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4);
 
       // <psi'|psi'>
-      auto NORMPSI = (prime(conj(eA), AUXLINK, 4) * M) * eA;
+      auto NORMPSI = prime(conj(eA), AUXLINK, 4) * MeA;
       // <psi'|U|psi>
       auto OVERLAP = prime(conj(eA), AUXLINK, 4) * K;
 
@@ -614,27 +624,32 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
         break;
       }
 
-      auto RES = M * eA - K;
+      auto RES = MeA - K;
       std::cout << "Norm(RES_A)= " << norm(RES) << std::endl;
 
-      // eA: aux, aux, phys
-      // K : aux^offset, aux^offset, phys^offset
-      M *= delta(phys[0], prime(phys[0], 4));
-      K.prime(PHYS, 4);
-
-      auto cmb0 = combiner(iQA, cls.AIc(tn[0], pl[0]), phys[0]);
-      auto cmb1 = combiner(prime(iQA, 4), prime(cls.AIc(tn[0], pl[0]), 4),
-                           prime(phys[0], 4));
-      M = (cmb0 * M) * cmb1;
-      // regularize Hessian
-      // std::vector<double> eps_reg(combinedIndex(cmb0, epsregularisation));
-      // M += diagTensor(eps_reg, combinedIndex(cmb0), combinedIndex(cmb1));
-      K *= cmb1;
-      eA *= cmb0;
-
-      linsystem(M, K, eA, ls, args);
-
-      eA *= cmb0;
+      if (matFree) {
+        // warm start from the current eA
+        linsystemMatFree(applyM, K, eA, 4, ls, args);
+      } else {
+        // eA: aux, aux, phys
+        // K : aux^offset, aux^offset, phys^offset
+        M *= delta(phys[0], prime(phys[0], 4));
+        K.prime(PHYS, 4);
+
+        auto cmb0 = combiner(iQA, cls.AIc(tn[0], pl[0]), phys[0]);
+        auto cmb1 = combiner(prime(iQA, 4), prime(cls.AIc(tn[0], pl[0]), 4),
+                             prime(phys[0], 4));
+        M = (cmb0 * M) * cmb1;
+        // regularize Hessian
+        // std::vector<double> eps_reg(combinedIndex(cmb0, epsregularisation));
+        // M += diagTensor(eps_reg, combinedIndex(cmb0), combinedIndex(cmb1));
+        K *= cmb1;
+        eA *= cmb0;
+
+        linsystem(M, K, eA, ls, args);
+
+        eA *= cmb0;
+      }
     }
 
     // Optimizing eB
@@ -642,14 +657,24 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
     {
       ITensor M =
         (eRE * eA) * delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1]));
-      M *= (prime(conj(eA), AUXLINK, 4) *
-            prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4));
+      ITensor MR =
+        prime(conj(eA), AUXLINK, 4) *
+        prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4);
+      // matrix-free solvers apply M = (eRE * eA) * MR to eB as a sequence
+      // of contractions, without forming it
+      bool const matFree = ls.matrixFree();
+      if (!matFree)
+        M *= MR;
+      auto applyM = [&](ITensor const& x) {
+        return matFree ? (M * x) * MR : M * x;
+      };
+      auto MeB = applyM(eB);
 
       ITensor K = protoK * prime(conj(eA), AUXLINK, 4);
       K *= prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4);
 
       // <psi'|psi'>
-      auto NORMPSI = (prime(conj(eB), AUXLINK, 4) * M) * eB;
+      auto NORMPSI = prime(conj(eB), AUXLINK, 4) * MeB;
       // <psi'|U|psi>
       auto OVERLAP = prime(conj(eB), AUXLINK, 4) * K;
 
@@ -675,22 +700,27 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
         converged = true;
         break;
       }
-      auto RES = M * eB - K;
+      auto RES = MeB - K;
       std::cout << "Norm(RES_B)= " << norm(RES) << std::endl;
 
-      M *= delta(phys[1], prime(phys[1], 4));
-      K.prime(PHYS, 4);
+      if (matFree) {
+        // warm start from the current eB
+        linsystemMatFree(applyM, K, eB, 4, ls, args);
+      } else {
+        M *= delta(phys[1], prime(phys[1], 4));
+        K.prime(PHYS, 4);
 
-      auto cmb0 = combiner(iQB, cls.AIc(tn[1], pl[1]), phys[1]);
-      auto cmb1 = combiner(prime(iQB, 4), prime(cls.AIc(tn[1], pl[1]), 4),
-                           prime(phys[1], 4));
-      M = (cmb0 * M) * cmb1;
-      K *= cmb1;
-      eB *= cmb0;
+        auto cmb0 = combiner(iQB, cls.AIc(tn[1], pl[1]), phys[1]);
+        auto cmb1 = combiner(prime(iQB, 4), prime(cls.AIc(tn[1], pl[1]), 4),
+                             prime(phys[1], 4));
+        M = (cmb0 * M) * cmb1;
+        K *= cmb1;
+        eB *= cmb0;
 
-      linsystem(M, K, eB, ls, args);
+        linsystem(M, K, eB, ls, args);
 
-      eB *= cmb0;
+        eB *= cmb0;
+      }
     }
 
     altlstsquares_iter++;
@@ -845,6 +875,9 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
     diag_data.add("diag_protoEnv_descriptor", diag_protoEnv_descriptor);
   }
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
 
@@ -945,12 +978,12 @@ Args fullUpdate_2S(MPO_2site const& mpo,
 
     // prepare map from on-site tensor aux-indices to half row/column T
     // environment tensors
-    std::array<const std::map<std::string, ITensor>* const, 4> iToT(
+    std::array<const CtmEnv::SiteTensorMap* const, 4> iToT(
       {&ctmEnv.T_L, &ctmEnv.T_U, &ctmEnv.T_R, &ctmEnv.T_D});
 
     // prepare map from on-site tensor aux-indices pair to half corner T-C-T
     // environment tensors
-    const std::map<int, const std::map<std::string, ITensor>* const> iToC(
+    const std::map<int, const CtmEnv::SiteTensorMap* const> iToC(
       {{23, &ctmEnv.C_RD},
        {32, &ctmEnv.C_RD},
        {21, &ctmEnv.C_RU},
@@ -1363,25 +1396,34 @@ Args fullUpdate_2S(MPO_2site const& mpo,
   vec_normPsi.push_back(sumels(NORMPSI));
 
   // Solve for eA*eB
-  auto M = (eRE * delta(phys[0], prime(phys[0], 4))) *
-           delta(phys[1], prime(phys[1], 4));
-  auto K = prime(protoK, PHYS, 4);
+  ITensor eAeB;
+  if (ls.matrixFree()) {
+    // warm start from the current eA*eB
+    eAeB = eA * delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])) * eB;
+    auto applyM = [&eRE](ITensor const& x) { return eRE * x; };
 
-  auto cmb0 = combiner(iQA, iQB, phys[0], phys[1]);
-  auto cmb1 = combiner(prime(iQA, 4), prime(iQB, 4), prime(phys[0], 4),
-                       prime(phys[1], 4));
-  M = (cmb0 * M) * cmb1;
-  K *= cmb1;
-  ITensor eAeB(combinedIndex(cmb0));
-  eAeB.fill(0.0);
+    linsystemMatFree(applyM, protoK, eAeB, 4, ls, args);
+  } else {
+    auto M = (eRE * delta(phys[0], prime(phys[0], 4))) *
+             delta(phys[1], prime(phys[1], 4));
+    auto K = prime(protoK, PHYS, 4);
 
-  Print(M);
-  Print(K);
-  Print(eAeB);
+    auto cmb0 = combiner(iQA, iQB, phys[0], phys[1]);
+    auto cmb1 = combiner(prime(iQA, 4), prime(iQB, 4), prime(phys[0], 4),
+                         prime(phys[1], 4));
+    M = (cmb0 * M) * cmb1;
+    K *= cmb1;
+    eAeB = ITensor(combinedIndex(cmb0));
+    eAeB.fill(0.0);
 
-  linsystem(M, K, eAeB, ls, args);
+    Print(M);
+    Print(K);
+    Print(eAeB);
 
-  eAeB *= cmb0;
+    linsystem(M, K, eAeB, ls, args);
+
+    eAeB *= cmb0;
+  }
 
   // svd on eAeB
   ITensor tempS, tmp_eA(iQA, phys[0]), tmp_eB;
@@ -1400,14 +1442,24 @@ Args fullUpdate_2S(MPO_2site const& mpo,
     {
       ITensor M =
         (eRE * eB) * delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0]));
-      M *= (prime(conj(eB), AUXLINK, 4) *
-            prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4));
+      ITensor MR =
+        prime(conj(eB), AUXLINK, 4) *
+        prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4);
+      // matrix-free solvers apply M = (eRE * eB) * MR to eA as a sequence
+      // of contractions, without forming it
+      bool const matFree = ls.matrixFree();
+      if (!matFree)
+        M *= MR;
+      auto applyM = [&](ITensor const& x) {
+        return matFree ? (M * x) * MR : M * x;
+      };
+      auto MeA = applyM(eA);
 
       ITensor K = protoK * prime(conj(eB), AUXLINK, 4);
       K *= prime(delta(cls.AIc(tn[1], pl[1]), cls.AIc(tn[0], pl[0])), 4);
 
       // <psi'|psi'>
-      auto NORMPSI = (prime(conj(eA), AUXLINK, 4) * M) * eA;
+      auto NORMPSI = prime(conj(eA), AUXLINK, 4) * MeA;
       // <psi'|U|psi>
       auto OVERLAP = prime(conj(eA), AUXLINK, 4) * K;
 
@@ -1434,27 +1486,32 @@ Args fullUpdate_2S(MPO_2site const& mpo,
         break;
       }
 
-      auto RES = M * eA - K;
+      auto RES = MeA - K;
       std::cout << "Norm(RES_A)= " << norm(RES) << std::endl;
 
-      // eA: aux, aux, phys
-      // K : aux^offset, aux^offset, phys^offset
-      M *= delta(phys[0], prime(phys[0], 4));
-      K.prime(PHYS, 4);
-
-      auto cmb0 = combiner(iQA, cls.AIc(tn[0], pl[0]), phys[0]);
-      auto cmb1 = combiner(prime(iQA, 4), prime(cls.AIc(tn[0], pl[0]), 4),
-                           prime(phys[0], 4));
-      M = (cmb0 * M) * cmb1;
-      // regularize Hessian
-      // std::vector<double> eps_reg(combinedIndex(cmb0, epsregularisation));
-      // M += diagTensor(eps_reg, combinedIndex(cmb0), combinedIndex(cmb1));
-      K *= cmb1;
-      eA *= cmb0;
-
-      linsystem(M, K, eA, ls, args);
-
-      eA *= cmb0;
+      if (matFree) {
+        // warm start from the current eA
+        linsystemMatFree(applyM, K, eA, 4, ls, args);
+      } else {
+        // eA: aux, aux, phys
+        // K : aux^offset, aux^offset, phys^offset
+        M *= delta(phys[0], prime(phys[0], 4));
+        K.prime(PHYS, 4);
+
+        auto cmb0 = combiner(iQA, cls.AIc(tn[0], pl[0]), phys[0]);
+        auto cmb1 = combiner(prime(iQA, 4), prime(cls.AIc(tn[0], pl[0]), 4),
+                             prime(phys[0], 4));
+        M = (cmb0 * M) * cmb1;
+        // regularize Hessian
+        // std::vector<double> eps_reg(combinedIndex(cmb0, epsregularisation));
+        // M += diagTensor(eps_reg, combinedIndex(cmb0), combinedIndex(cmb1));
+        K *= cmb1;
+        eA *= cmb0;
+
+        linsystem(M, K, eA, ls, args);
+
+        eA *= cmb0;
+      }
     }
 
     // Optimizing eB
@@ -1462,14 +1519,24 @@ Args fullUpdate_2S(MPO_2site const& mpo,
     {
       ITensor M =
         (eRE * eA) * delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1]));
-      M *= (prime(conj(eA), AUXLINK, 4) *
-            prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4));
+      ITensor MR =
+        prime(conj(eA), AUXLINK, 4) *
+        prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4);
+      // matrix-free solvers apply M = (eRE * eA) * MR to eB as a sequence
+      // of contractions, without forming it
+      bool const matFree = ls.matrixFree();
+      if (!matFree)
+        M *= MR;
+      auto applyM = [&](ITensor const& x) {
+        return matFree ? (M * x) * MR : M * x;
+      };
+      auto MeB = applyM(eB);
 
       ITensor K = protoK * prime(conj(eA), AUXLINK, 4);
       K *= prime(delta(cls.AIc(tn[0], pl[0]), cls.AIc(tn[1], pl[1])), 4);
 
       // <psi'|psi'>
-      auto NORMPSI = (prime(conj(eB), AUXLINK, 4) * M) * eB;
+      auto NORMPSI = prime(conj(eB), AUXLINK, 4) * MeB;
       // <psi'|U|psi>
       auto OVERLAP = prime(conj(eB), AUXLINK, 4) * K;
 
@@ -1495,22 +1562,27 @@ Args fullUpdate_2S(MPO_2site const& mpo,
         converged = true;
         break;
       }
-      auto RES = M * eB - K;
+      auto RES = MeB - K;
       std::cout << "Norm(RES_B)= " << norm(RES) << std::endl;
 
-      M *= delta(phys[1], prime(phys[1], 4));
-      K.prime(PHYS, 4);
+      if (matFree) {
+        // warm start from the current eB
+        linsystemMatFree(applyM, K, eB, 4, ls, args);
+      } else {
+        M *= delta(phys[1], prime(phys[1], 4));
+        K.prime(PHYS, 4);
 
-      auto cmb0 = combiner(iQB, cls.AIc(tn[1], pl[1]), phys[1]);
-      auto cmb1 = combiner(prime(iQB, 4), prime(cls.AIc(tn[1], pl[1]), 4),
-                           prime(phys[1], 4));
-      M = (cmb0 * M) * cmb1;
-      K *= cmb1;
-      eB *= cmb0;
+        auto cmb0 = combiner(iQB, cls.AIc(tn[1], pl[1]), phys[1]);
+        auto cmb1 = combiner(prime(iQB, 4), prime(cls.AIc(tn[1], pl[1]), 4),
+                             prime(phys[1], 4));
+        M = (cmb0 * M) * cmb1;
+        K *= cmb1;
+        eB *= cmb0;
 
-      linsystem(M, K, eB, ls, args);
+        linsystem(M, K, eB, ls, args);
 
-      eB *= cmb0;
+        eB *= cmb0;
+      }
     }
 
     altlstsquares_iter++;
@@ -1690,5 +1762,8 @@ Args fullUpdate_2S(MPO_2site const& mpo,
     diag_data.add("diag_protoEnv_descriptor", diag_protoEnv_descriptor);
   }
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
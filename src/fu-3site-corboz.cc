@@ -1550,5 +1550,8 @@ Args fu_3s_corboz(MPO_3site const& u123,
   diag_data.add("minEvKept", minEvKept);
   // diag_data.add("maxEvDisc",maxEvDisc);
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
@@ -87,12 +87,12 @@ Args fullUpdate_CG_full4S(OpNS const& uJ1J2,
 
     // prepare map from on-site tensor aux-indices to half row/column T
     // environment tensors
-    std::array<const std::map<std::string, ITensor>* const, 4> iToT(
+    std::array<const CtmEnv::SiteTensorMap* const, 4> iToT(
       {&ctmEnv.T_L, &ctmEnv.T_U, &ctmEnv.T_R, &ctmEnv.T_D});
 
     // prepare map from on-site tensor aux-indices pair to half corner T-C-T
     // environment tensors
-    const std::map<int, const std::map<std::string, ITensor>* const> iToC(
+    const std::map<int, const CtmEnv::SiteTensorMap* const> iToC(
       {{23, &ctmEnv.C_LU},
        {32, &ctmEnv.C_LU},
        {21, &ctmEnv.C_LD},
@@ -337,6 +337,9 @@ Args fullUpdate_CG_full4S(OpNS const& uJ1J2,
   diag_data.add("minEvKept", -1);    // minEvKept);
   diag_data.add("maxEvDisc", 0.0);   // maxEvDisc);
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
 
@@ -1597,6 +1597,9 @@ Args fullUpdate(MPO_3site const& uJ1J2,
   diag_data.add("minEvKept", minEvKept);
   // diag_data.add("maxEvDisc",maxEvDisc);
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
 
@@ -2332,5 +2335,8 @@ Args fullUpdate_ALS2S_IT(MPO_2site const& mpo,
     diag_data.add("diag_protoEnv_descriptor", diag_protoEnv_descriptor);
   }
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
@@ -0,0 +1,219 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/auto-svd-solver.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+
+namespace itensor {
+
+  namespace {
+
+    int log2Ceil(long x) {
+      int b = 0;
+      while ((1L << b) < x)
+        b++;
+      return b;
+    }
+
+  }  // namespace
+
+  void AutoSvdSolver::addCandidate(std::string const& name,
+                                   std::unique_ptr<SvdSolver> solver) {
+    names.push_back(name);
+    solvers.push_back(std::move(solver));
+  }
+
+  AutoSvdSolver::Key AutoSvdSolver::bucket(bool cplx,
+                                           long rows,
+                                           long cols,
+                                           long maxm) {
+    return Key(cplx, log2Ceil(rows), log2Ceil(cols), log2Ceil(maxm));
+  }
+
+  std::string AutoSvdSolver::selected(bool cplx,
+                                      long rows,
+                                      long cols,
+                                      long maxm) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = table.find(bucket(cplx, rows, cols, maxm));
+    if (it == table.end() || it->second.choice < 0)
+      return "";
+    return names[it->second.choice];
+  }
+
+  template <typename T>
+  void AutoSvdSolver::solveImpl(MatRefc<T> const& M,
+                                MatRef<T> const& U,
+                                VectorRef const& D,
+                                MatRef<T> const& V,
+                                Args const& args) {
+    if (solvers.empty())
+      throw std::runtime_error("[AutoSvdSolver] No candidate solvers");
+
+    long nsv = std::min(nrows(M), ncols(M));
+    long maxm = std::min<long>(args.getInt("Maxm", nsv), nsv);
+    bool const cplx = std::is_same<T, Cplx>::value;
+    auto const key = bucket(cplx, nrows(M), ncols(M), maxm);
+    auto const nc = solvers.size();
+
+    // look up the bucket. Candidates rejected by earlier trials are
+    // skipped by this one
+    int choice;
+    std::vector<bool> accurate;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      auto file = args.getString("auto_svd_cache", "");
+      if (!file.empty() && file != cacheFile) {
+        cacheFile = file;
+        loadCache(cacheFile);
+      }
+      auto& b = table[key];
+      b.time.resize(nc, 0.0);
+      b.accurate.resize(nc, true);
+      choice = b.choice;
+      accurate = b.accurate;
+    }
+    if (choice >= 0) {
+      solvers[choice]->solve(M, U, D, V, args);
+      return;
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::vector<double> time(nc, 0.0);
+    auto tol = args.getReal("auto_svd_tol", 1.0e-8);
+
+    // reference
+    auto t0 = clock::now();
+    solvers[0]->solve(M, U, D, V, args);
+    time[0] = std::chrono::duration<double>(clock::now() - t0).count();
+
+    Mat<T> Uc(nrows(U), ncols(U)), Vc(nrows(V), ncols(V));
+    Vector Dc(D.size());
+    for (size_t c = 1; c < nc; c++) {
+      if (!accurate[c])
+        continue;
+      try {
+        t0 = clock::now();
+        solvers[c]->solve(M, makeRef(Uc), makeRef(Dc), makeRef(Vc), args);
+        time[c] = std::chrono::duration<double>(clock::now() - t0).count();
+      } catch (std::exception const&) {
+        accurate[c] = false;
+        continue;
+      }
+      for (long s = 0; s < maxm; s++)
+        if (std::abs(Dc(s) - D(s)) > tol * D(0)) {
+          accurate[c] = false;
+          break;
+        }
+    }
+
+    // record the trial, unless the bucket was calibrated meanwhile
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& b = table[key];
+    if (b.choice >= 0)
+      return;
+    for (size_t c = 0; c < nc; c++) {
+      b.time[c] += time[c];
+      b.accurate[c] = b.accurate[c] && accurate[c];
+    }
+    if (++b.trials < args.getInt("auto_svd_trials", 3))
+      return;
+
+    b.choice = 0;
+    for (size_t c = 1; c < nc; c++)
+      if (b.accurate[c] && b.time[c] < b.time[b.choice])
+        b.choice = static_cast<int>(c);
+    if (args.getBool("svd_dbg", false))
+      std::cout << "[AutoSvdSolver] " << nrows(M) << "x" << ncols(M)
+                << " Maxm " << maxm << " -> " << names[b.choice] << std::endl;
+    saveCache();
+  }
+
+  void AutoSvdSolver::solve(MatRefc<Real> const& M,
+                            MatRef<Real> const& U,
+                            VectorRef const& D,
+                            MatRef<Real> const& V,
+                            Args const& args) {
+    solveImpl(M, U, D, V, args);
+  }
+
+  void AutoSvdSolver::solve(MatRefc<Cplx> const& M,
+                            MatRef<Cplx> const& U,
+                            VectorRef const& D,
+                            MatRef<Cplx> const& V,
+                            Args const& args) {
+    solveImpl(M, U, D, V, args);
+  }
+
+  void AutoSvdSolver::loadCache(std::string const& filename) {
+    std::ifstream infile(filename);
+    if (!infile.good())
+      return;
+
+    nlohmann::json jCache;
+    try {
+      infile >> jCache;
+    } catch (std::exception const&) {
+      std::cout << "[AutoSvdSolver] Ignoring invalid cache " << filename
+                << std::endl;
+      return;
+    }
+    for (auto const& entry : jCache["buckets"]) {
+      auto name = entry["solver"].get<std::string>();
+      auto it = std::find(names.begin(), names.end(), name);
+      if (it == names.end())
+        continue;
+      auto key = bucket(entry["cplx"].get<bool>(), entry["rows"].get<long>(),
+                        entry["cols"].get<long>(), entry["maxm"].get<long>());
+      table[key].choice = it - names.begin();
+    }
+  }
+
+  void AutoSvdSolver::saveCache() const {
+    if (cacheFile.empty())
+      return;
+
+    nlohmann::json jCache;
+    jCache["buckets"] = nlohmann::json::array();
+    for (auto const& kv : table) {
+      if (kv.second.choice < 0)
+        continue;
+      nlohmann::json entry;
+      entry["cplx"] = std::get<0>(kv.first);
+      entry["rows"] = 1L << std::get<1>(kv.first);
+      entry["cols"] = 1L << std::get<2>(kv.first);
+      entry["maxm"] = 1L << std::get<3>(kv.first);
+      entry["solver"] = names[kv.second.choice];
+      jCache["buckets"].push_back(entry);
+    }
+
+    // concurrent jobs sharing the cache never read a partially written
+    // file. The temporary file is unique to this process and solver
+    std::ostringstream tmpName;
+    tmpName << cacheFile << ".tmp." << getpid() << "." << this;
+    {
+      std::ofstream outf(tmpName.str());
+      outf << jCache.dump(4) << std::endl;
+      if (!outf.good()) {
+        std::cout << "[AutoSvdSolver] Failed to write cache " << cacheFile
+                  << std::endl;
+        std::remove(tmpName.str().c_str());
+        return;
+      }
+    }
+    if (std::rename(tmpName.str().c_str(), cacheFile.c_str()) != 0) {
+      std::cout << "[AutoSvdSolver] Failed to write cache " << cacheFile
+                << std::endl;
+      std::remove(tmpName.str().c_str());
+    }
+  }
+
+}  // namespace itensor
@@ -74,6 +74,26 @@ namespace itensor {
     linsystemRank2(A, B, X, *this, args);
   }
 
+  void linsystemMatFree(
+    std::function<ITensor(ITensor const&)> const& applyA,
+    ITensor B,
+    ITensor& X,
+    int dpl,
+    LinSysSolver const& solver,
+    Args const& args) {
+    if (!solver.matrixFree())
+      throw std::runtime_error(
+        "[linsystemMatFree] Solver does not support matrix-free mode");
+
+    auto op = [&applyA, dpl](ITensor const& x) {
+      auto y = applyA(x);
+      y.mapprime(dpl, 0);
+      return y;
+    };
+    B.mapprime(dpl, 0);
+    solver.solveMatFree(op, B, X, args);
+  }
+
   template <typename T>
   void linsystemMatVec(MatRefc<T> const& A,
                        VecRef<T> const& B,
@@ -26,6 +26,7 @@ namespace itensor {
                    ITensor& U,
                    ITensor& D,
                    ITensor& V,
+                   ITensor const& U0,
                    SvdSolver& solver,
                    Args const& args) {
     SCOPED_TIMER(7);
@@ -49,7 +50,20 @@ namespace itensor {
     Vector DD;
 
     TIMER_START(6)
-    SVD(M, UU, DD, VV, solver, args);
+    if (U0 && (isComplex(U0) == isComplex(A))) {
+      // U0 holds the guess of left singular vectors as (ui, link)
+      auto lk = (U0.inds()[0] == ui) ? U0.inds()[1] : U0.inds()[0];
+      auto G = toMatRefc<T>(U0, ui, lk);
+      auto Mr = nrows(M), Mc = ncols(M);
+      auto nsv = std::min(Mr, Mc);
+      resize(UU, Mr, nsv);
+      resize(VV, Mc, nsv);
+      resize(DD, nsv);
+      solver.solveWithGuess(M, makeRef(UU), makeRef(DD), makeRef(VV), G,
+                            args);
+    } else {
+      SVD(M, UU, DD, VV, solver, args);
+    }
     TIMER_STOP(6)
 
     // conjugate VV so later we can just do
@@ -89,7 +103,14 @@ namespace itensor {
       showEigs(probs, truncerr, A.scale(), showargs);
     }
 
-    Index uL(lname, m, litype), vL(rname, m, ritype);
+    Index uL, vL;
+#ifdef PEPS_WITH_OPENMP
+#pragma omp critical(itensor_index_gen)
+#endif
+    {
+      uL = Index(lname, m, litype);
+      vL = Index(rname, m, ritype);
+    }
 
     // Fix sign to make sure D has positive elements
     Real signfix = (A.scale().sign() == -1) ? -1 : +1;
@@ -122,6 +143,7 @@ namespace itensor {
                     ITensorT<IndexT>& U,
                     ITensorT<IndexT>& D,
                     ITensorT<IndexT>& V,
+                    ITensorT<IndexT> const& U0,
                     SvdSolver& solver,
                     Args args) {
     auto do_truncate = args.defined("Cutoff") || args.defined("Maxm");
@@ -134,9 +156,9 @@ namespace itensor {
       Error("A must be matrix-like (rank 2)");
     }
     if (isComplex(A)) {
-      return svdImpl<Cplx>(A, ui, vi, U, D, V, solver, args);
+      return svdImpl<Cplx>(A, ui, vi, U, D, V, U0, solver, args);
     }
-    return svdImpl<Real>(A, ui, vi, U, D, V, solver, args);
+    return svdImpl<Real>(A, ui, vi, U, D, V, U0, solver, args);
   }
   template Spectrum svdRank2(ITensor const&,
                              Index const&,
@@ -144,6 +166,7 @@ namespace itensor {
                              ITensor&,
                              ITensor&,
                              ITensor&,
+                             ITensor const&,
                              SvdSolver&,
                              Args);
   // template Spectrum
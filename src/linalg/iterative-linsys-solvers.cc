@@ -0,0 +1,242 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/iterative-linsys-solvers.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace itensor {
+
+  namespace {
+
+    // real part of <a|b>, which is the only part entering the recurrences
+    // for hermitian A
+    Real innerRe(ITensor const& a, ITensor const& b) {
+      return (dag(a) * b).cplx().real();
+    }
+
+    bool hasIndsOf(ITensor const& X, ITensor const& B) {
+      if (!X || rank(X) != rank(B))
+        return false;
+      for (auto const& i : B.inds())
+        if (!hasindex(X, i))
+          return false;
+      return true;
+    }
+
+    // X <- X + a*y, X might not be initialized yet
+    void axpy(ITensor& X, Real a, ITensor const& y) {
+      if (X)
+        X += a * y;
+      else
+        X = a * y;
+    }
+
+    void extract(ITensor const& x, Index const& i, VecRef<Real> const& X) {
+      for (long r = 0; r < i.m(); r++)
+        X(r) = x.real(i(r + 1));
+    }
+
+    void extract(ITensor const& x, Index const& i, VecRef<Cplx> const& X) {
+      for (long r = 0; r < i.m(); r++)
+        X(r) = x.cplx(i(r + 1));
+    }
+
+    // Dense A and B are wrapped into tensors and passed to the
+    // matrix-free solver, starting from X = 0
+    template <typename T>
+    void solveDense(LinSysSolver const& solver,
+                    MatRefc<T> const& A,
+                    VecRef<T> const& B,
+                    VecRef<T> const& X,
+                    Args const& args) {
+      long n = nrows(A);
+      if (ncols(A) != n || static_cast<long>(B.size()) != n)
+        throw std::runtime_error(
+          "[LinSysSolver::solve] A is not square or does not match B");
+
+      auto i = Index("x", n);
+      std::vector<T> a(n * n), b(n);
+      for (long c = 0; c < n; c++)
+        for (long r = 0; r < n; r++)
+          a[c * n + r] = A(r, c);
+      for (long r = 0; r < n; r++)
+        b[r] = B(r);
+      auto tA = ITensor({prime(i), i}, Dense<T>(std::move(a)));
+      auto tB = ITensor({i}, Dense<T>(std::move(b)));
+
+      ITensor tX;
+      solver.solveMatFree(
+        [&tA](ITensor const& x) { return noprime(tA * x); }, tB, tX, args);
+      extract(tX, i, X);
+    }
+
+  }  // namespace
+
+  void CGSolver::solveMatFree(
+    std::function<ITensor(ITensor const&)> const& applyA,
+    ITensor const& B,
+    ITensor& X,
+    Args const& args) const {
+    auto dbg = args.getBool("dbg", false);
+    auto tol = args.getReal("linsysTol", 1.0e-10);
+    auto maxIter = args.getInt("linsysMaxIter", 500);
+
+    auto bnrm = norm(B);
+    if (bnrm == 0.0) {
+      X = B;
+      return;
+    }
+
+    ITensor r = B;
+    if (hasIndsOf(X, B))
+      r -= applyA(X);
+    else
+      X = ITensor();
+    ITensor p = r;
+    Real rr = innerRe(r, r);
+
+    int it = 0;
+    for (; it < maxIter && std::sqrt(rr) >= tol * bnrm; it++) {
+      auto Ap = applyA(p);
+      auto pAp = innerRe(p, Ap);
+      if (pAp <= 0.0) {
+        if (dbg)
+          std::cout << "[CGSolver::solveMatFree] A is not positive definite"
+                    << " <p|A|p>: " << pAp << std::endl;
+        break;
+      }
+      auto alpha = rr / pAp;
+      axpy(X, alpha, p);
+      r -= alpha * Ap;
+      auto rrNew = innerRe(r, r);
+      p = r + (rrNew / rr) * p;
+      rr = rrNew;
+    }
+    if (!X) {
+      X = B;
+      X.fill(0.0);
+    }
+
+    if (dbg)
+      std::cout << "[CGSolver::solveMatFree] iterations: " << it
+                << " |r|/|b|: " << std::sqrt(rr) / bnrm << std::endl;
+  }
+
+  void CGSolver::solve(MatRefc<Real> const& A,
+                       VecRef<Real> const& B,
+                       VecRef<Real> const& X,
+                       Args const& args) const {
+    solveDense(*this, A, B, X, args);
+  }
+
+  void CGSolver::solve(MatRefc<Cplx> const& A,
+                       VecRef<Cplx> const& B,
+                       VecRef<Cplx> const& X,
+                       Args const& args) const {
+    solveDense(*this, A, B, X, args);
+  }
+
+  std::unique_ptr<CGSolver> CGSolver::create() {
+    return std::unique_ptr<CGSolver>(new CGSolver());
+  }
+
+  // Unpreconditioned MINRES following C.C. Paige and M.A. Saunders,
+  // SIAM J. Numer. Anal. 12, 617 (1975). The Lanczos vectors are
+  // generated by three-term recurrence and the least-squares problem is
+  // updated by Givens rotations (cs, sn). phibar is the norm of the
+  // current residual
+  void MinresSolver::solveMatFree(
+    std::function<ITensor(ITensor const&)> const& applyA,
+    ITensor const& B,
+    ITensor& X,
+    Args const& args) const {
+    auto dbg = args.getBool("dbg", false);
+    auto tol = args.getReal("linsysTol", 1.0e-10);
+    auto maxIter = args.getInt("linsysMaxIter", 500);
+    Real const eps = std::numeric_limits<Real>::epsilon();
+
+    auto bnrm = norm(B);
+    if (bnrm == 0.0) {
+      X = B;
+      return;
+    }
+
+    ITensor r1 = B;
+    if (hasIndsOf(X, B))
+      r1 -= applyA(X);
+    else
+      X = ITensor();
+    ITensor r2 = r1, y = r1;
+    ITensor v, w, w1, w2;
+
+    Real oldb = 0.0, beta = norm(r1), dbar = 0.0, epsln = 0.0;
+    Real phibar = beta, cs = -1.0, sn = 0.0;
+
+    int it = 0;
+    while (it < maxIter && phibar >= tol * bnrm && beta > 0.0) {
+      it++;
+      // Lanczos step
+      v = (1.0 / beta) * y;
+      y = applyA(v);
+      if (it >= 2)
+        y -= (beta / oldb) * r1;
+      auto alfa = innerRe(v, y);
+      y -= (alfa / beta) * r2;
+      r1 = r2;
+      r2 = y;
+      oldb = beta;
+      beta = norm(r2);
+
+      // apply previous rotation and compute the new one
+      auto oldeps = epsln;
+      auto delt = cs * dbar + sn * alfa;
+      auto gbar = sn * dbar - cs * alfa;
+      epsln = sn * beta;
+      dbar = -cs * beta;
+      auto gamma = std::max(std::hypot(gbar, beta), eps);
+      cs = gbar / gamma;
+      sn = beta / gamma;
+      auto phi = cs * phibar;
+      phibar = sn * phibar;
+
+      // update search direction and solution
+      w1 = w2;
+      w2 = w;
+      w = v;
+      if (w1)
+        w -= oldeps * w1;
+      if (w2)
+        w -= delt * w2;
+      w *= 1.0 / gamma;
+      axpy(X, phi, w);
+    }
+    if (!X) {
+      X = B;
+      X.fill(0.0);
+    }
+
+    if (dbg)
+      std::cout << "[MinresSolver::solveMatFree] iterations: " << it
+                << " |r|/|b|: " << phibar / bnrm << std::endl;
+  }
+
+  void MinresSolver::solve(MatRefc<Real> const& A,
+                           VecRef<Real> const& B,
+                           VecRef<Real> const& X,
+                           Args const& args) const {
+    solveDense(*this, A, B, X, args);
+  }
+
+  void MinresSolver::solve(MatRefc<Cplx> const& A,
+                           VecRef<Cplx> const& B,
+                           VecRef<Cplx> const& X,
+                           Args const& args) const {
+    solveDense(*this, A, B, X, args);
+  }
+
+  std::unique_ptr<MinresSolver> MinresSolver::create() {
+    return std::unique_ptr<MinresSolver>(new MinresSolver());
+  }
+
+}  // namespace itensor
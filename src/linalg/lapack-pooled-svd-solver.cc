@@ -0,0 +1,393 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/lapack-pooled-svd-solver.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace itensor {
+
+#ifdef LAPACK_REQUIRE_EXTERN
+  extern "C" {
+  void F77NAME(dgesdd)(char* jobz,
+                       LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       double* a,
+                       LAPACK_INT* lda,
+                       double* s,
+                       double* u,
+                       LAPACK_INT* ldu,
+                       double* vt,
+                       LAPACK_INT* ldvt,
+                       double* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* iwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(dgesvd)(char* jobu,
+                       char* jobvt,
+                       LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       double* a,
+                       LAPACK_INT* lda,
+                       double* s,
+                       double* u,
+                       LAPACK_INT* ldu,
+                       double* vt,
+                       LAPACK_INT* ldvt,
+                       double* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(zgesvd)(char* jobu,
+                       char* jobvt,
+                       LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       LAPACK_COMPLEX* a,
+                       LAPACK_INT* lda,
+                       double* s,
+                       LAPACK_COMPLEX* u,
+                       LAPACK_INT* ldu,
+                       LAPACK_COMPLEX* vt,
+                       LAPACK_INT* ldvt,
+                       LAPACK_COMPLEX* work,
+                       LAPACK_INT* lwork,
+                       double* rwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(dgejsv)(char* joba,
+                       char* jobu,
+                       char* jobv,
+                       char* jobr,
+                       char* jobt,
+                       char* jobp,
+                       LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       double* a,
+                       LAPACK_INT* lda,
+                       double* sva,
+                       double* u,
+                       LAPACK_INT* ldu,
+                       double* v,
+                       LAPACK_INT* ldv,
+                       double* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* iwork,
+                       LAPACK_INT* info);
+  }  // extern "C"
+#endif
+
+  namespace {
+
+    // copy of the input, V^dag as returned by ?gesdd, ?gesvd and LAPACK
+    // workspaces for a single (driver, jobz, m, n)
+    template <typename T>
+    struct SvdWorkspace {
+      bool queried = false;
+      std::vector<T> a, vt, work;
+      std::vector<Real> rwork;
+      std::vector<LAPACK_INT> iwork;
+    };
+
+    template <typename T>
+    SvdWorkspace<T>& pooledWorkspace(int driver,
+                                     char jobz,
+                                     LAPACK_INT m,
+                                     LAPACK_INT n) {
+      using Key = std::tuple<int, char, LAPACK_INT, LAPACK_INT>;
+      thread_local std::map<Key, SvdWorkspace<T>> pool;
+      auto key = Key(driver, jobz, m, n);
+      // CTM decomposes matrices of a handful of shapes. A pool grown
+      // beyond that (i.e. by adaptive x) is discarded
+      if (pool.size() >= 64 && pool.find(key) == pool.end())
+        pool.clear();
+      return pool[key];
+    }
+
+    LAPACK_INT workSize(Real wq) {
+      return std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq));
+    }
+
+    LAPACK_INT workSize(Cplx wq) {
+      return std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq.real()));
+    }
+
+    LAPACK_COMPLEX* lp(Cplx* p) { return reinterpret_cast<LAPACK_COMPLEX*>(p); }
+
+    // ?gesdd/?gesvd with jobz = 'S' of column-major m x n matrix w.a
+    // (m <= n). Singular values and U are written into s and u, V^dag
+    // into w.vt
+    LAPACK_INT gesdd(SvdWorkspace<Real>& w,
+                     LAPACK_INT m,
+                     LAPACK_INT n,
+                     Real* s,
+                     Real* u) {
+      char jobz = 'S';
+      LAPACK_INT l = std::min(m, n);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      if (!w.queried) {
+        Real wq = 0.0;
+        w.iwork.resize(8 * l);
+        F77NAME(dgesdd)
+        (&jobz, &m, &n, w.a.data(), &m, s, u, &m, w.vt.data(), &l, &wq,
+         &lwork, w.iwork.data(), &info);
+        w.work.resize(workSize(wq));
+        w.queried = true;
+      }
+      lwork = w.work.size();
+      F77NAME(dgesdd)
+      (&jobz, &m, &n, w.a.data(), &m, s, u, &m, w.vt.data(), &l,
+       w.work.data(), &lwork, w.iwork.data(), &info);
+      return info;
+    }
+
+    LAPACK_INT gesdd(SvdWorkspace<Cplx>& w,
+                     LAPACK_INT m,
+                     LAPACK_INT n,
+                     Real* s,
+                     Cplx* u) {
+      char jobz = 'S';
+      LAPACK_INT l = std::min(m, n);
+      LAPACK_INT g = std::max(m, n);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      if (!w.queried) {
+        Cplx wq = 0.0;
+        w.iwork.resize(8 * l);
+        w.rwork.resize(std::max<LAPACK_INT>(
+          1, l * std::max(5 * l + 7, 2 * g + 2 * l + 1)));
+        F77NAME(zgesdd)
+        (&jobz, &m, &n, lp(w.a.data()), &m, s, lp(u), &m, lp(w.vt.data()), &l,
+         lp(&wq), &lwork, w.rwork.data(), w.iwork.data(), &info);
+        w.work.resize(workSize(wq));
+        w.queried = true;
+      }
+      lwork = w.work.size();
+      F77NAME(zgesdd)
+      (&jobz, &m, &n, lp(w.a.data()), &m, s, lp(u), &m, lp(w.vt.data()), &l,
+       lp(w.work.data()), &lwork, w.rwork.data(), w.iwork.data(), &info);
+      return info;
+    }
+
+    LAPACK_INT gesvd(SvdWorkspace<Real>& w,
+                     LAPACK_INT m,
+                     LAPACK_INT n,
+                     Real* s,
+                     Real* u) {
+      char job = 'S';
+      LAPACK_INT l = std::min(m, n);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      if (!w.queried) {
+        Real wq = 0.0;
+        F77NAME(dgesvd)
+        (&job, &job, &m, &n, w.a.data(), &m, s, u, &m, w.vt.data(), &l, &wq,
+         &lwork, &info);
+        w.work.resize(workSize(wq));
+        w.queried = true;
+      }
+      lwork = w.work.size();
+      F77NAME(dgesvd)
+      (&job, &job, &m, &n, w.a.data(), &m, s, u, &m, w.vt.data(), &l,
+       w.work.data(), &lwork, &info);
+      return info;
+    }
+
+    LAPACK_INT gesvd(SvdWorkspace<Cplx>& w,
+                     LAPACK_INT m,
+                     LAPACK_INT n,
+                     Real* s,
+                     Cplx* u) {
+      char job = 'S';
+      LAPACK_INT l = std::min(m, n);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      if (!w.queried) {
+        Cplx wq = 0.0;
+        w.rwork.resize(5 * l);
+        F77NAME(zgesvd)
+        (&job, &job, &m, &n, lp(w.a.data()), &m, s, lp(u), &m,
+         lp(w.vt.data()), &l, lp(&wq), &lwork, w.rwork.data(), &info);
+        w.work.resize(workSize(wq));
+        w.queried = true;
+      }
+      lwork = w.work.size();
+      F77NAME(zgesvd)
+      (&job, &job, &m, &n, lp(w.a.data()), &m, s, lp(u), &m, lp(w.vt.data()),
+       &l, lp(w.work.data()), &lwork, w.rwork.data(), &info);
+      return info;
+    }
+
+    // dgejsv of column-major m x n matrix w.a (m >= n), computing n left
+    // singular vectors u (m x n) and right singular vectors v (n x n).
+    // dgejsv does not support workspace query, hence its documented
+    // (near-)optimal size is used
+    LAPACK_INT gejsv(SvdWorkspace<Real>& w,
+                     LAPACK_INT m,
+                     LAPACK_INT n,
+                     Real* s,
+                     Real* u,
+                     Real* v) {
+      char joba = 'C', jobu = 'U', jobv = 'V', jobr = 'N', jobt = 'N',
+           jobp = 'N';
+      LAPACK_INT const nb = 64;
+      LAPACK_INT info = 0;
+      if (!w.queried) {
+        w.work.resize(std::max({2 * m + n, 6 * n + 2 * n * n,
+                                m + 3 * n + n * n + n * nb,
+                                2 * n + n * n + n * nb}));
+        w.iwork.resize(std::max<LAPACK_INT>(3, m + 3 * n));
+        w.queried = true;
+      }
+      LAPACK_INT lwork = w.work.size();
+      F77NAME(dgejsv)
+      (&joba, &jobu, &jobv, &jobr, &jobt, &jobp, &m, &n, w.a.data(), &m, s,
+       u, &m, v, &n, w.work.data(), &lwork, w.iwork.data(), &info);
+      // singular values are returned scaled by work(2)/work(1)
+      if (info == 0 && w.work[0] != w.work[1])
+        for (LAPACK_INT k = 0; k < n; k++)
+          s[k] *= w.work[0] / w.work[1];
+      return info;
+    }
+
+    LAPACK_INT gejsv(SvdWorkspace<Cplx>&,
+                     LAPACK_INT,
+                     LAPACK_INT,
+                     Real*,
+                     Cplx*,
+                     Cplx*) {
+      throw std::logic_error("[LapackSvdSolver] dgejsv of complex matrix");
+    }
+
+    // dst <- transpose of column-major rows x cols matrix src
+    template <typename T>
+    void transposeCopy(T const* src, long rows, long cols, T* dst) {
+      for (long k = 0; k < rows * cols; k++)
+        dst[k / rows + cols * (k % rows)] = src[k];
+    }
+
+    Real conjIfCplx(Real v) { return v; }
+
+    Cplx conjIfCplx(Cplx v) { return std::conj(v); }
+
+    // SVD of m x n matrix M with m <= n
+    template <typename T>
+    void pooledSvd(LapackSvdSolver::DRIVER driver,
+                   MatRefc<T> const& M,
+                   MatRef<T> const& U,
+                   VectorRef const& D,
+                   MatRef<T> const& V) {
+      LAPACK_INT m = nrows(M), n = ncols(M);
+      LAPACK_INT l = std::min(m, n);
+      // dgejsv requires rows >= cols, hence it decomposes M^T = V D U^T
+      bool const jacobi =
+        driver == LapackSvdSolver::GEJSV && std::is_same<T, Real>::value;
+      if (driver == LapackSvdSolver::GEJSV && !jacobi)
+        driver = LapackSvdSolver::GESVD;
+
+      auto& w = pooledWorkspace<T>(driver, 'S', m, n);
+      w.a.resize(m * n);
+      if (!jacobi)
+        w.vt.resize(l * n);
+
+      // ?gesdd, ?gesvd read column-major M, dgejsv column-major M^T.
+      // Transposed M is stored as column-major M^T
+      auto pA = M.data();
+      if (isTransposed(M) == jacobi)
+        std::copy(pA, pA + m * n, w.a.data());
+      else if (jacobi)
+        transposeCopy(pA, m, n, w.a.data());
+      else
+        transposeCopy(pA, n, m, w.a.data());
+
+      LAPACK_INT info = 0;
+      std::string name;
+      auto ncD = const_cast<Real*>(D.data());
+      if (jacobi) {
+        name = "dgejsv";
+        info = gejsv(w, n, m, ncD, V.data(), U.data());
+      } else if (driver == LapackSvdSolver::GESDD) {
+        name = "?gesdd";
+        info = gesdd(w, m, n, ncD, U.data());
+      } else {
+        name = "?gesvd";
+        info = gesvd(w, m, n, ncD, U.data());
+      }
+      if (info != 0)
+        throw std::runtime_error("[LapackSvdSolver] " + name +
+                                 " failed with info: " + std::to_string(info));
+
+      // V^dag (l x n, column-major) into V (n x l, column-major)
+      if (!jacobi) {
+        auto pV = V.data();
+        for (long k = 0; k < l * n; k++)
+          pV[k] = conjIfCplx(w.vt[(k % n) * l + k / n]);
+      }
+    }
+
+    template <typename T>
+    void solveImpl(LapackSvdSolver& solver,
+                   MatRefc<T> const& M,
+                   MatRef<T> const& U,
+                   VectorRef const& D,
+                   MatRef<T> const& V,
+                   Args const& args) {
+      auto Mr = nrows(M);
+      auto Mc = ncols(M);
+      if (Mr > Mc) {
+        solver.solve(transpose(M), V, D, U, args);
+        conjugate(V);
+        conjugate(U);
+#ifdef CHKSVD
+        checksvd(M, U, D, V);
+#endif
+        return;
+      }
+#ifdef DEBUG
+      if (!(nrows(U) == Mr && ncols(U) == Mr))
+        throw std::runtime_error("SVD (ref version), wrong size of U");
+      if (!(nrows(V) == Mc && ncols(V) == Mr))
+        throw std::runtime_error("SVD (ref version), wrong size of V");
+      if (D.size() != Mr)
+        throw std::runtime_error("SVD (ref version), wrong size of D");
+#endif
+      pooledSvd(solver.driver, M, U, D, V);
+#ifdef CHKSVD
+      checksvd(M, U, D, V);
+#endif
+    }
+
+  }  // namespace
+
+  void LapackSvdSolver::solve(MatRefc<Real> const& M,
+                              MatRef<Real> const& U,
+                              VectorRef const& D,
+                              MatRef<Real> const& V,
+                              Args const& args) {
+    solveImpl(*this, M, U, D, V, args);
+  }
+
+  void LapackSvdSolver::solve(MatRefc<Cplx> const& M,
+                              MatRef<Cplx> const& U,
+                              VectorRef const& D,
+                              MatRef<Cplx> const& V,
+                              Args const& args) {
+    solveImpl(*this, M, U, D, V, args);
+  }
+
+  std::unique_ptr<LapackSvdSolver> LapackSvdSolver::createGesdd() {
+    return std::unique_ptr<LapackSvdSolver>(new LapackSvdSolver(GESDD));
+  }
+
+  std::unique_ptr<LapackSvdSolver> LapackSvdSolver::createGesvd() {
+    return std::unique_ptr<LapackSvdSolver>(new LapackSvdSolver(GESVD));
+  }
+
+  std::unique_ptr<LapackSvdSolver> LapackSvdSolver::createGejsv() {
+    return std::unique_ptr<LapackSvdSolver>(new LapackSvdSolver(GEJSV));
+  }
+
+}  // namespace itensor
@@ -0,0 +1,235 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/rsvd-lapack-solver.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace itensor {
+
+#ifdef LAPACK_REQUIRE_EXTERN
+  extern "C" {
+  void F77NAME(dgeqrf)(LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       double* a,
+                       LAPACK_INT* lda,
+                       double* tau,
+                       double* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(zgeqrf)(LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       LAPACK_COMPLEX* a,
+                       LAPACK_INT* lda,
+                       LAPACK_COMPLEX* tau,
+                       LAPACK_COMPLEX* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(dorgqr)(LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       LAPACK_INT* k,
+                       double* a,
+                       LAPACK_INT* lda,
+                       double* tau,
+                       double* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* info);
+
+  void F77NAME(zungqr)(LAPACK_INT* m,
+                       LAPACK_INT* n,
+                       LAPACK_INT* k,
+                       LAPACK_COMPLEX* a,
+                       LAPACK_INT* lda,
+                       LAPACK_COMPLEX* tau,
+                       LAPACK_COMPLEX* work,
+                       LAPACK_INT* lwork,
+                       LAPACK_INT* info);
+  }  // extern "C"
+#endif
+
+  namespace {
+
+    // Q <- orthonormal basis of the columns of column-major m x n matrix Q
+    // (m >= n), computed in place. Workspace size is obtained by a query
+    // with lwork = -1
+    LAPACK_INT orthonormalize(Mat<Real>& Q) {
+      LAPACK_INT m = nrows(Q), n = ncols(Q);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      std::vector<Real> tau(n);
+      Real wq = 0.0;
+      F77NAME(dgeqrf)(&m, &n, Q.data(), &m, tau.data(), &wq, &lwork, &info);
+      lwork = std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq));
+      std::vector<Real> work(lwork);
+      F77NAME(dgeqrf)
+      (&m, &n, Q.data(), &m, tau.data(), work.data(), &lwork, &info);
+      if (info != 0)
+        return info;
+
+      lwork = -1;
+      F77NAME(dorgqr)
+      (&m, &n, &n, Q.data(), &m, tau.data(), &wq, &lwork, &info);
+      lwork = std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq));
+      work.resize(lwork);
+      F77NAME(dorgqr)
+      (&m, &n, &n, Q.data(), &m, tau.data(), work.data(), &lwork, &info);
+      return info;
+    }
+
+    LAPACK_INT orthonormalize(Mat<Cplx>& Q) {
+      LAPACK_INT m = nrows(Q), n = ncols(Q);
+      LAPACK_INT info = 0;
+      LAPACK_INT lwork = -1;
+      std::vector<Cplx> tau(n);
+      Cplx wq = 0.0;
+      auto pQ = reinterpret_cast<LAPACK_COMPLEX*>(Q.data());
+      auto pTau = reinterpret_cast<LAPACK_COMPLEX*>(tau.data());
+      auto pWq = reinterpret_cast<LAPACK_COMPLEX*>(&wq);
+      F77NAME(zgeqrf)(&m, &n, pQ, &m, pTau, pWq, &lwork, &info);
+      lwork = std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq.real()));
+      std::vector<Cplx> work(lwork);
+      F77NAME(zgeqrf)
+      (&m, &n, pQ, &m, pTau, reinterpret_cast<LAPACK_COMPLEX*>(work.data()),
+       &lwork, &info);
+      if (info != 0)
+        return info;
+
+      lwork = -1;
+      F77NAME(zungqr)(&m, &n, &n, pQ, &m, pTau, pWq, &lwork, &info);
+      lwork = std::max<LAPACK_INT>(1, static_cast<LAPACK_INT>(wq.real()));
+      work.resize(lwork);
+      F77NAME(zungqr)
+      (&m, &n, &n, pQ, &m, pTau,
+       reinterpret_cast<LAPACK_COMPLEX*>(work.data()), &lwork, &info);
+      return info;
+    }
+
+    template <typename T>
+    void orth(Mat<T>& Q) {
+      auto info = orthonormalize(Q);
+      if (info != 0)
+        throw std::runtime_error(
+          "[RandomizedSvdSolver] QR failed with info: " + std::to_string(info));
+    }
+
+    // The generator is seeded for each call from "svd_seed" and the shape
+    // of M, so the sketch does not depend on which thread (or in which
+    // order) the decompositions are run
+    std::mt19937 sketchRng(Args const& args, long rows, long cols) {
+      std::seed_seq seq{args.getInt("svd_seed", 1234), int(rows), int(cols)};
+      return std::mt19937(seq);
+    }
+
+    void gaussian(Mat<Real>& G, std::mt19937& rng) {
+      std::normal_distribution<double> dist(0.0, 1.0);
+      for (auto& e : G)
+        e = dist(rng);
+    }
+
+    void gaussian(Mat<Cplx>& G, std::mt19937& rng) {
+      std::normal_distribution<double> dist(0.0, 1.0 / std::sqrt(2.0));
+      for (auto& e : G) {
+        double const re = dist(rng);
+        e = Cplx(re, dist(rng));
+      }
+    }
+
+    // A^dag B
+    template <typename T>
+    Mat<T> adjointTimes(MatRefc<T> const& A, MatRefc<T> const& B) {
+      Mat<T> Ac(A);
+      conjugate(makeRef(Ac));
+      return transpose(Ac) * B;
+    }
+
+    template <typename T>
+    bool rsvdImpl(MatRefc<T> const& M,
+                  MatRef<T> const& U,
+                  VectorRef const& D,
+                  MatRef<T> const& V,
+                  Args const& args) {
+      auto Mr = nrows(M), Mc = ncols(M);
+      long nsv = std::min(Mr, Mc);
+      long maxm = std::min<long>(args.getInt("Maxm", nsv), nsv);
+      auto q = args.getInt("rsvd_power", 2);
+      auto s = args.getInt("rsvd_reortho", 1);
+      auto p = args.getInt("rsvd_oversampling", 10);
+
+      // dimension of the sampled subspace
+      long l = std::min(nsv, maxm + p);
+      if (l >= nsv || l > ncols(U) || l > ncols(V))
+        return false;
+
+      auto rng = sketchRng(args, Mr, Mc);
+      Mat<T> Q(Mc, l);
+      gaussian(Q, rng);
+      Q = M * Q;
+      orth(Q);
+
+      // power iterations, with intermediate orthonormalization every
+      // s-th step (never for s <= 0)
+      for (int it = 1; it <= q; it++) {
+        bool const reortho = s > 0 && it % s == 0;
+        Mat<T> Z = adjointTimes<T>(M, makeRef(Q));
+        if (reortho)
+          orth(Z);
+        Q = M * Z;
+        if (reortho || it == q)
+          orth(Q);
+      }
+
+      // Q^dag M = Ub D Vb^dag. D and V are written directly into the
+      // leading l entries and columns of the output
+      Mat<T> B = adjointTimes<T>(makeRef(Q), M);
+      MatRefc<T> Bref = makeRef(B);
+      Mat<T> Ub(l, l);
+      for (auto& el : U)
+        el = 0.0;
+      for (auto& el : V)
+        el = 0.0;
+      for (auto& el : D)
+        el = 0.0;
+      auto thresh = args.getReal("SVDThreshold", 1E-3);
+      SVDRef(Bref, makeRef(Ub), subVector(D, 0, l), columns(V, 0, l), thresh);
+      columns(U, 0, l) &= Q * Ub;
+      return true;
+    }
+
+  }  // namespace
+
+  void RandomizedSvdSolver::solve(MatRefc<Real> const& M,
+                                  MatRef<Real> const& U,
+                                  VectorRef const& D,
+                                  MatRef<Real> const& V,
+                                  Args const& args) {
+    if (!rsvdImpl(M, U, D, V, args)) {
+      SvdSolver::solve(M, U, D, V, args);
+      return;
+    }
+#ifdef CHKSVD
+    checksvd(M, U, D, V);
+#endif
+  }
+
+  void RandomizedSvdSolver::solve(MatRefc<Cplx> const& M,
+                                  MatRef<Cplx> const& U,
+                                  VectorRef const& D,
+                                  MatRef<Cplx> const& V,
+                                  Args const& args) {
+    if (!rsvdImpl(M, U, D, V, args)) {
+      SvdSolver::solve(M, U, D, V, args);
+      return;
+    }
+#ifdef CHKSVD
+    checksvd(M, U, D, V);
+#endif
+  }
+
+  std::unique_ptr<RandomizedSvdSolver> RandomizedSvdSolver::create() {
+    return std::unique_ptr<RandomizedSvdSolver>(new RandomizedSvdSolver());
+  }
+
+}  // namespace itensor
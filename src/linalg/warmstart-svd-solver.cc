@@ -0,0 +1,124 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linalg/warmstart-svd-solver.h"
+#include <random>
+
+namespace itensor {
+
+  void WarmStartSvdSolver::solve(MatRefc<Real> const& M,
+                                 MatRef<Real> const& U,
+                                 VectorRef const& D,
+                                 MatRef<Real> const& V,
+                                 Args const& args) {
+    SvdSolver::solve(M, U, D, V, args);
+  }
+
+  void WarmStartSvdSolver::solve(MatRefc<Cplx> const& M,
+                                 MatRef<Cplx> const& U,
+                                 VectorRef const& D,
+                                 MatRef<Cplx> const& V,
+                                 Args const& args) {
+    SvdSolver::solve(M, U, D, V, args);
+  }
+
+  void WarmStartSvdSolver::solveWithGuess(MatRefc<Real> const& M,
+                                          MatRef<Real> const& U,
+                                          VectorRef const& D,
+                                          MatRef<Real> const& V,
+                                          MatRefc<Real> const& U0,
+                                          Args const& args) {
+    bool dbg = args.getBool("svd_dbg", false);
+    auto Mr = nrows(M), Mc = ncols(M);
+    long nsv = std::min(Mr, Mc);
+    long maxm = std::min<long>(args.getInt("Maxm", nsv), nsv);
+    auto iters = args.getInt("warmstart_iter", 2);
+    auto tol = args.getReal("warmstart_tol", 1.0e-6);
+    auto p = args.getInt("rsvd_oversampling", 10);
+
+    // dimension of the subspace
+    long k = std::min(nsv, maxm + p);
+    if (k >= nsv || ncols(U0) == 0 || nrows(U0) != Mr) {
+      solve(M, U, D, V, args);
+      return;
+    }
+
+    // initial subspace from the guess, completed by random samples of
+    // range of M if the guess is too narrow (i.e. after increase of chi)
+    Mat<Real> Q(Mr, k);
+    long kg = std::min<long>(ncols(U0), k);
+    for (long c = 0; c < kg; c++)
+      column(Q, c) &= column(U0, c);
+    if (kg < k) {
+      // seeded per call, as in RandomizedSvdSolver, so the padding does
+      // not depend on the thread running the decomposition
+      std::seed_seq seq{args.getInt("svd_seed", 1234), int(Mr), int(Mc)};
+      std::mt19937 rng(seq);
+      std::normal_distribution<double> dist(0.0, 1.0);
+      Mat<Real> G(Mc, k - kg);
+      for (auto& e : G)
+        e = dist(rng);
+      columns(Q, kg, k) &= M * G;
+    }
+    orthog(Q);
+
+    Mat<Real> Z;
+    for (int it = 0; it < iters; it++) {
+      Z = transpose(M) * Q;
+      orthog(Z);
+      Q = M * Z;
+      orthog(Q);
+    }
+
+    // Rayleigh-Ritz within span(Q): Q^T M = Ub Db Vb^T
+    Mat<Real> B = transpose(Q) * M;
+    Mat<Real> Ub, Vb;
+    Vector Db;
+    SVD(B, Ub, Db, Vb);
+    Mat<Real> Uk = Q * Ub;
+
+    // residual of the leading maxm singular triplets
+    Mat<Real> R = transpose(M) * columns(Uk, 0, maxm);
+    for (long c = 0; c < maxm; c++)
+      column(R, c) -= Db(c) * column(Vb, c);
+    double res = (Db(0) > 0.0) ? norm(R) / Db(0) : 0.0;
+
+    if (dbg)
+      std::cout << "[WarmStartSvdSolver::solveWithGuess] " << Mr << "x" << Mc
+                << " k=" << k << " residual=" << res << std::endl;
+
+    if (!(res < tol)) {
+      solve(M, U, D, V, args);
+      return;
+    }
+
+    // only the leading k singular triplets are computed, the rest
+    // is set to zero
+    for (auto& el : U)
+      el = 0.0;
+    for (auto& el : V)
+      el = 0.0;
+    for (auto& el : D)
+      el = 0.0;
+    columns(U, 0, k) &= Uk;
+    columns(V, 0, k) &= Vb;
+    subVector(D, 0, k) &= Db;
+
+#ifdef CHKSVD
+    checksvd(M, U, D, V);
+#endif
+  }
+
+  // No complex implementation, fall back to full decomposition
+  void WarmStartSvdSolver::solveWithGuess(MatRefc<Cplx> const& M,
+                                          MatRef<Cplx> const& U,
+                                          VectorRef const& D,
+                                          MatRef<Cplx> const& V,
+                                          MatRefc<Cplx> const& /* U0 */,
+                                          Args const& args) {
+    solve(M, U, D, V, args);
+  }
+
+  std::unique_ptr<WarmStartSvdSolver> WarmStartSvdSolver::create() {
+    return std::unique_ptr<WarmStartSvdSolver>(new WarmStartSvdSolver());
+  }
+
+}  // namespace itensor
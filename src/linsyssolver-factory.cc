@@ -0,0 +1,34 @@
+#include "pi-peps/config.h"
+#include "pi-peps/linsyssolver-factory.h"
+#include "pi-peps/linalg/iterative-linsys-solvers.h"
+#include "pi-peps/linalg/linsyssolvers-lapack.h"
+
+LinSysSolverFactory::LinSysSolverFactory() {
+  registerSolver("pseudoinverse", &itensor::PseudoInvSolver::create);
+  registerSolver("cholesky", &itensor::CholeskySolver::create);
+  registerSolver("cg", &itensor::CGSolver::create);
+  registerSolver("minres", &itensor::MinresSolver::create);
+}
+
+bool LinSysSolverFactory::registerSolver(std::string const& name,
+                                         TCreateMethod funcCreate) {
+  auto it = s_methods.find(name);
+  if (it == s_methods.end()) {
+    s_methods[name] = funcCreate;
+    return true;
+  }
+  return false;
+}
+
+std::unique_ptr<itensor::LinSysSolver> LinSysSolverFactory::create(
+  std::string const& name) {
+  auto it = s_methods.find(name);
+  if (it != s_methods.end())
+    return it->second();  // call the "create" function
+
+  std::string message =
+    "[LinSysSolverFactory] Invalid linsys solver: " + name;
+  throw std::runtime_error(message);
+
+  return nullptr;
+}
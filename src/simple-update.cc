@@ -1055,6 +1055,9 @@ Args simpleUpdate(MPO_2site const& u12,
     if (lw.dirs[0] == pl[0])
       cls.weights[lw.wId] = l12;
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
 
@@ -1149,6 +1152,9 @@ Args simpleUpdate(MPO_3site const& u123,
     if (lw.dirs[0] == pl[3])
       cls.weights[lw.wId] = l23;
 
+  // on-site tensors of the cluster have changed
+  cls.siteVersion++;
+
   return diag_data;
 }
 
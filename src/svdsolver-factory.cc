@@ -1,18 +1,56 @@
 #include "pi-peps/config.h"
 #include "pi-peps/svdsolver-factory.h"
 #include "pi-peps/linalg/arpack-rcdn.h"
+#include "pi-peps/linalg/auto-svd-solver.h"
+#include "pi-peps/linalg/krylov-solvers.h"
+#include "pi-peps/linalg/lapack-pooled-svd-solver.h"
 #include "pi-peps/linalg/lapacksvd-solver.h"
+#include "pi-peps/linalg/rsvd-lapack-solver.h"
 #include "pi-peps/linalg/rsvd-solver.h"
+#include "pi-peps/linalg/warmstart-svd-solver.h"
+
+namespace {
+
+  // Candidates of the auto-tuned solver. The first one, exact and
+  // robust, serves as the reference for the accuracy check
+  std::unique_ptr<itensor::SvdSolver> createAutoSvdSolver() {
+    SvdSolverFactory sf = SvdSolverFactory();
+    std::unique_ptr<itensor::AutoSvdSolver> solver(
+      new itensor::AutoSvdSolver());
+    for (auto const& name :
+         {"gesdd", "itensor", "gesdd-pool", "rsvd-lapack", "lanczos"})
+      solver->addCandidate(name, sf.create(name));
+#ifdef PEPS_WITH_RSVD
+    solver->addCandidate("rsvd", sf.create("rsvd"));
+#endif
+#ifdef PEPS_WITH_ARPACK
+    solver->addCandidate("arpack", sf.create("arpack"));
+#endif
+    return std::move(solver);
+  }
+
+}  // namespace
 
 SvdSolverFactory::SvdSolverFactory() {
   registerSolver("default", &itensor::SvdSolver::create);
   registerSolver("itensor", &itensor::SvdSolver::create);
   registerSolver("gesdd", &itensor::GESDDSolver::create);
+  registerSolver("gesdd-pool", &itensor::LapackSvdSolver::createGesdd);
+  registerSolver("gesvd", &itensor::LapackSvdSolver::createGesvd);
+  registerSolver("gejsv", &itensor::LapackSvdSolver::createGejsv);
+  registerSolver("warmstart", &itensor::WarmStartSvdSolver::create);
+  registerSolver("rsvd-lapack", &itensor::RandomizedSvdSolver::create);
+  registerSolver("lanczos", &itensor::LanczosSvdSolver::create);
 #ifdef PEPS_WITH_RSVD
   registerSolver("rsvd", &itensor::RsvdSolver::create);
+#else
+  registerSolver("rsvd", &itensor::RandomizedSvdSolver::create);
 #endif
+  registerSolver("auto", &createAutoSvdSolver);
 #ifdef PEPS_WITH_ARPACK
   registerSolver("arpack", &itensor::ArpackSvdSolver::create);
+#else
+  registerSolver("arpack", &itensor::LanczosSvdSolver::create);
 #endif
 }
 
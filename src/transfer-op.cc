@@ -1,8 +1,6 @@
 #include "pi-peps/transfer-op.h"
 
-#ifdef PEPS_WITH_ARPACK
-
-#  define pow_2(a) ((a) * (a))
+#define pow_2(a) ((a) * (a))
 
 namespace itensor {
 
@@ -21,9 +19,7 @@ namespace itensor {
     };
 
     auto getSiteBraKet = [this, &vToId](Vertex const& v) {
-      return ev.p_cluster->sites.at(vToId(v)) *
-             dag(ev.p_cluster->sites.at(vToId(v)))
-               .prime(AUXLINK, ev.p_cluster->BRAKET_OFFSET);
+      return ev.p_ctmEnv->siteBraKet(vToId(v));
     };
 
     auto applyDeltaEdge = [this](ITensor& t, Vertex const& v, DIRECTION edge,
@@ -243,36 +239,44 @@ namespace itensor {
                              CtmEnv::DIRECTION dir,
                              int num_eigs,
                              std::string alg_type) {
-    if (alg_type == "ARPACK") {
-      TransferOpVecProd tvp(ev, v, dir);
-
-      int N = pow_2(ev.p_cluster->AIc(v, dir).m()) * pow_2(ev.p_ctmEnv->x);
+    TransferOpVecProd tvp(ev, v, dir);
+    int N = pow_2(ev.p_cluster->AIc(v, dir).m()) * pow_2(ev.p_ctmEnv->x);
+
+    std::vector<std::complex<double>> eigv;
+    if (alg_type == "ARNOLDI") {
+      ArnoldiEig<TransferOpVecProd> arnoldi(tvp);
+
+      std::vector<std::complex<double>> X;
+      int nconv = arnoldi.real_nonsymm(N, num_eigs, 2 * num_eigs + 20, 1.0e-10,
+                                       300, eigv, X);
+      if (nconv < num_eigs)
+        std::cout << "[analyzeTransferMatrix] Converged " << nconv << " of "
+                  << num_eigs << " eigenvalues" << std::endl;
+#ifdef PEPS_WITH_ARPACK
+    } else if (alg_type == "ARPACK") {
       ARDNS<TransferOpVecProd> ardns(tvp);
 
-      std::vector<std::complex<double>> eigv;
       std::vector<double> V;
       ardns.real_nonsymm(N, num_eigs, 100, 0.0, N * 10, eigv, V);
-
-      // sort
-      std::sort(
-        eigv.begin(), eigv.end(),
-        [](std::complex<double> const& a, std::complex<double> const& b) {
-          return std::abs(a) > std::abs(b);
-        });
-      for (auto const& val : eigv) {
-        std::cout << val / std::abs(eigv[0]) << std::endl;
-      }
-
+#endif
     } else {
       std::cout << "[EVBuilder::analyzeTransferMatrix] Unsupported option: "
                 << alg_type << std::endl;
+      return;
+    }
+
+    // sort
+    std::sort(eigv.begin(), eigv.end(),
+              [](std::complex<double> const& a, std::complex<double> const& b) {
+                return std::abs(a) > std::abs(b);
+              });
+    for (auto const& val : eigv) {
+      std::cout << val / std::abs(eigv[0]) << std::endl;
     }
   }
 
 }  // namespace itensor
 
-#endif
-
 namespace itensor {
 
   TransferOpVecProd_itensor::TransferOpVecProd_itensor(EVBuilder const& ev_,
@@ -288,9 +292,7 @@ namespace itensor {
     };
 
     auto getSiteBraKet = [this, &vToId](Vertex const& v) {
-      return ev.p_cluster->sites.at(vToId(v)) *
-             dag(ev.p_cluster->sites.at(vToId(v)))
-               .prime(AUXLINK, ev.p_cluster->BRAKET_OFFSET);
+      return ev.p_ctmEnv->siteBraKet(vToId(v));
     };
 
     auto applyDeltaEdge = [this](ITensor& t, Vertex const& v, DIRECTION edge,
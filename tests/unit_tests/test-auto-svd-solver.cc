@@ -0,0 +1,117 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/auto-svd-solver.h"
+#include "pi-peps/linalg/lapack-pooled-svd-solver.h"
+#include "pi-peps/linalg/rsvd-lapack-solver.h"
+
+using namespace itensor;
+
+namespace {
+
+  void addCandidates(AutoSvdSolver& solver) {
+    solver.addCandidate("itensor", SvdSolver::create());
+    solver.addCandidate("gesdd-pool", LapackSvdSolver::createGesdd());
+    solver.addCandidate("rsvd-lapack", RandomizedSvdSolver::create());
+  }
+
+}  // namespace
+
+// Bucket is calibrated after auto_svd_trials decompositions, all of which
+// (and the later ones) return an accurate truncated spectrum
+TEST(SvdAutoReal0, Default_cotr) {
+  double eps = 1.0e-08;
+  int maxm = 4;
+  Index i("i", 30), j("j", 20);
+
+  AutoSvdSolver solver;
+  addCandidates(solver);
+  Args args = {"Maxm", maxm, "auto_svd_trials", 2, "auto_svd_cache", ""};
+
+  for (int rep = 0; rep < 4; rep++) {
+    EXPECT_EQ(solver.selected(false, 30, 20, maxm).empty(), rep < 2);
+    auto T = randomTensor(i, j);
+
+    SvdSolver ref_solver = SvdSolver();
+    ITensor Ur(i), Dr, Vr;
+    svd(T, Ur, Dr, Vr, ref_solver, {"Maxm", maxm});
+
+    ITensor U(i), D, V;
+    svd(T, U, D, V, solver, args);
+    EXPECT_TRUE(norm(Ur * Dr * Vr - U * D * V) < eps * norm(T));
+  }
+  // the same bucket
+  EXPECT_FALSE(solver.selected(false, 29, 17, maxm).empty());
+  EXPECT_TRUE(solver.selected(true, 30, 20, maxm).empty());
+}
+
+// Choices persist through the cache file
+TEST(SvdAutoReal1, Default_cotr) {
+  std::string cache = "test-svd-autotune.json";
+  std::remove(cache.c_str());
+  Index i("i", 12), j("j", 10);
+  Args args = {"auto_svd_trials", 1, "auto_svd_cache", cache};
+
+  AutoSvdSolver solver0;
+  addCandidates(solver0);
+  ITensor U0(i), D0, V0;
+  svd(randomTensor(i, j), U0, D0, V0, solver0, args);
+  auto choice = solver0.selected(false, 12, 10, 10);
+  EXPECT_FALSE(choice.empty());
+
+  AutoSvdSolver solver1;
+  addCandidates(solver1);
+  ITensor U1(i), D1, V1;
+  svd(randomTensor(i, j), U1, D1, V1, solver1, args);
+  EXPECT_EQ(solver1.selected(false, 12, 10, 10), choice);
+  std::remove(cache.c_str());
+}
+
+// Decompositions issued concurrently, as by CTM with ctmThreads > 1,
+// share the table of buckets
+TEST(SvdAutoConcurrent, Default_cotr) {
+  double eps = 1.0e-08;
+  int maxm = 4;
+  Index i("i", 24), j("j", 16);
+  long const nsv = j.m();
+
+  AutoSvdSolver solver;
+  addCandidates(solver);
+  Args args = {"Maxm", maxm, "auto_svd_trials", 3, "auto_svd_cache", ""};
+
+  std::vector<ITensor> Ts;
+  for (int k = 0; k < 16; k++)
+    Ts.push_back(randomTensor(i, j));
+  std::vector<double> err(Ts.size(), 1.0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++)
+    threads.emplace_back([&, t]() {
+      for (size_t k = t; k < Ts.size(); k += 4) {
+        auto M = toMatRefc<Real>(Ts[k], i, j);
+        Mat<Real> U(i.m(), nsv), V(j.m(), nsv), Ur(i.m(), nsv),
+          Vr(j.m(), nsv);
+        Vector D(nsv), Dr(nsv);
+        solver.solve(M, makeRef(U), makeRef(D), makeRef(V), args);
+        SvdSolver ref_solver = SvdSolver();
+        ref_solver.solve(M, makeRef(Ur), makeRef(Dr), makeRef(Vr), args);
+        err[k] = 0.0;
+        for (int s = 0; s < maxm; s++)
+          err[k] = std::max(err[k], std::abs(D(s) - Dr(s)) / Dr(0));
+      }
+    });
+  for (auto& th : threads)
+    th.join();
+
+  for (auto e : err)
+    EXPECT_TRUE(e < eps);
+  EXPECT_FALSE(solver.selected(false, 24, 16, maxm).empty());
+}
@@ -3,6 +3,7 @@
 #include "pi-peps/ctm-cluster-basic.h"
 #include "pi-peps/ctm-cluster-io.h"
 #include "pi-peps/ctm-cluster.h"
+#include <array>
 #include <iostream>
 #include <string>
 
@@ -124,3 +125,28 @@ TEST(ClusterBasic0_2x2_ABCD, Default_cotr) {
 //   auto cluster = Cluster_2x2_ABCD(3, 2);
 //   std::cout << cluster;
 // }
+
+TEST(ClusterSymmetrizeC4v_1x1_A, Invariance) {
+  nlohmann::json jCls;
+  jCls["type"] = "1X1_A";
+  jCls["physDim"] = 2;
+  jCls["auxBondDim"] = 3;
+  jCls["initBy"] = "RANDOM";
+
+  auto p_cls = Cluster_1x1_A::create(jCls);
+  auto version = p_cls->siteVersion;
+  p_cls->symmetrizeC4v();
+  EXPECT_TRUE(p_cls->siteVersion > version);
+
+  auto const& A = p_cls->sites.at("A");
+  auto const& aux = p_cls->caux.at("A");
+  // rotation by pi/2 and reflection exchanging directions 0 and 2
+  std::vector<std::array<int, 4>> g = {{{1, 2, 3, 0}}, {{2, 1, 0, 3}}};
+  for (auto const& p : g) {
+    auto t = A;
+    for (int dir = 0; dir < 4; dir++)
+      t *= delta(aux[dir], prime(aux[p[dir]], 100));
+    t.prime(AUXLINK, -100);
+    EXPECT_TRUE(norm(t - A) < 1.0e-12 * norm(A));
+  }
+}
@@ -197,13 +197,20 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
                  true, "dbgLevel", 3});
   ctmEnv.init(CtmEnv::INIT_ENV_ctmrg, false, true);
 
+  // halves with edge combiners built as in the plan of a CTM move
+  auto halves = [&ctmEnv](DIRECTION direction, Vertex const& v, ITensor& t,
+                          ITensor& tt) {
+    ctmEnv.build_halves_V2(direction, v,
+                           ctmEnv.build_halves_combiners(direction, v), t, tt);
+  };
+
   //              1
   // directions 0   2  where 0: A B , 1: B A , 2: D C , 3: C D
   //              3             C D      D C      B A      A B
   // site A = Vertex(0,0) ----------------------------------------------------
   ITensor t, tt;
-  ctmEnv.build_halves_V2(DIRECTION::LEFT, Vertex(0, 0), t,
-                         tt);  // direction left: t->upper half, tt->lower half
+  // direction left: t->upper half, tt->lower half
+  halves(DIRECTION::LEFT, Vertex(0, 0), t, tt);
   EXPECT_TRUE(t.r() == 6);
   EXPECT_TRUE(tt.r() == 6);
   EXPECT_TRUE(hasindex(t, cls.AIc("A", 3)));
@@ -219,8 +226,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("C")[1]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("D")[1]));
 
-  ctmEnv.build_halves_V2(DIRECTION::UP, Vertex(0, 0), t,
-                         tt);  // direction up: t->right half, tt->left half
+  // direction up: t->right half, tt->left half
+  halves(DIRECTION::UP, Vertex(0, 0), t, tt);
   EXPECT_TRUE(t.r() == 6);
   EXPECT_TRUE(tt.r() == 6);
   EXPECT_TRUE(hasindex(t, cls.AIc("A", 0)));
@@ -236,8 +243,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("B")[2]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::DOWN].at("D")[2]));
 
-  ctmEnv.build_halves_V2(DIRECTION::RIGHT, Vertex(0, 0), t,
-                         tt);  // direction right: t->lower half, tt->upper half
+  // direction right: t->lower half, tt->upper half
+  halves(DIRECTION::RIGHT, Vertex(0, 0), t, tt);
   EXPECT_TRUE(t.r() == 6);
   EXPECT_TRUE(tt.r() == 6);
   EXPECT_TRUE(hasindex(t, cls.AIc("A", 1)));
@@ -253,8 +260,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("C")[3]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("D")[3]));
 
-  ctmEnv.build_halves_V2(DIRECTION::DOWN, Vertex(0, 0), t,
-                         tt);  // direction down: t->left half, tt->right half
+  // direction down: t->left half, tt->right half
+  halves(DIRECTION::DOWN, Vertex(0, 0), t, tt);
   EXPECT_TRUE(t.r() == 6);
   EXPECT_TRUE(tt.r() == 6);
   EXPECT_TRUE(hasindex(t, cls.AIc("A", 2)));
@@ -271,8 +278,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("D")[0]));
 
   // site B = Vertex(1,0) ----------------------------------------------------
-  ctmEnv.build_halves_V2(DIRECTION::LEFT, Vertex(1, 0), t,
-                         tt);  // direction left: t->upper half, tt->lower half
+  // direction left: t->upper half, tt->lower half
+  halves(DIRECTION::LEFT, Vertex(1, 0), t, tt);
   // B--A
   // 3  3
   // 1  1
@@ -292,8 +299,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("D")[1]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("C")[1]));
 
-  ctmEnv.build_halves_V2(DIRECTION::UP, Vertex(1, 0), t,
-                         tt);  // direction up: t->right half, tt->left half
+  // direction up: t->right half, tt->left half
+  halves(DIRECTION::UP, Vertex(1, 0), t, tt);
   // A--2 0--B
   // |       |
   // C--2 0--D
@@ -312,8 +319,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("A")[2]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::DOWN].at("C")[2]));
 
-  ctmEnv.build_halves_V2(DIRECTION::RIGHT, Vertex(1, 0), t,
-                         tt);  // direction right: t->lower half, tt->upper half
+  // direction right: t->lower half, tt->upper half
+  halves(DIRECTION::RIGHT, Vertex(1, 0), t, tt);
   // C--D
   // 3  3
   // 1  1
@@ -333,8 +340,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("D")[3]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("C")[3]));
 
-  ctmEnv.build_halves_V2(DIRECTION::DOWN, Vertex(1, 0), t,
-                         tt);  // direction down: t->left half, tt->right half
+  // direction down: t->left half, tt->right half
+  halves(DIRECTION::DOWN, Vertex(1, 0), t, tt);
   // D--2 0--C
   // |       |
   // B--2 0--A
@@ -354,8 +361,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("C")[0]));
 
   // site C = Vertex(0,1) ----------------------------------------------------
-  ctmEnv.build_halves_V2(DIRECTION::LEFT, Vertex(0, 1), t,
-                         tt);  // direction left: t->upper half, tt->lower half
+  // direction left: t->upper half, tt->lower half
+  halves(DIRECTION::LEFT, Vertex(0, 1), t, tt);
   // C--D
   // 3  3
   // 1  1
@@ -375,8 +382,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("A")[1]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("B")[1]));
 
-  ctmEnv.build_halves_V2(DIRECTION::UP, Vertex(0, 1), t,
-                         tt);  // direction up: t->right half, tt->left half
+  // direction up: t->right half, tt->left half
+  halves(DIRECTION::UP, Vertex(0, 1), t, tt);
   // D--2 0--C
   // |       |
   // B--2 0--A
@@ -395,8 +402,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("D")[2]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::DOWN].at("B")[2]));
 
-  ctmEnv.build_halves_V2(DIRECTION::RIGHT, Vertex(0, 1), t,
-                         tt);  // direction right: t->lower half, tt->upper half
+  // direction right: t->lower half, tt->upper half
+  halves(DIRECTION::RIGHT, Vertex(0, 1), t, tt);
   // B--A
   // 3  3
   // 1  1
@@ -416,8 +423,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("A")[3]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("B")[3]));
 
-  ctmEnv.build_halves_V2(DIRECTION::DOWN, Vertex(0, 1), t,
-                         tt);  // direction down: t->left half, tt->right half
+  // direction down: t->left half, tt->right half
+  halves(DIRECTION::DOWN, Vertex(0, 1), t, tt);
   // A--2 0--B
   // |       |
   // C--2 0--D
@@ -437,8 +444,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("B")[0]));
 
   // site D = Vertex(1,1) ----------------------------------------------------
-  ctmEnv.build_halves_V2(DIRECTION::LEFT, Vertex(1, 1), t,
-                         tt);  // direction left: t->upper half, tt->lower half
+  // direction left: t->upper half, tt->lower half
+  halves(DIRECTION::LEFT, Vertex(1, 1), t, tt);
   // D--C
   // 3  3
   // 1  1
@@ -458,8 +465,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("B")[1]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("A")[1]));
 
-  ctmEnv.build_halves_V2(DIRECTION::UP, Vertex(1, 1), t,
-                         tt);  // direction up: t->right half, tt->left half
+  // direction up: t->right half, tt->left half
+  halves(DIRECTION::UP, Vertex(1, 1), t, tt);
   // C--2 0--D
   // |       |
   // A--2 0--B
@@ -478,8 +485,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::UP].at("C")[2]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::DOWN].at("A")[2]));
 
-  ctmEnv.build_halves_V2(DIRECTION::RIGHT, Vertex(1, 1), t,
-                         tt);  // direction right: t->lower half, tt->upper half
+  // direction right: t->lower half, tt->upper half
+  halves(DIRECTION::RIGHT, Vertex(1, 1), t, tt);
   // A--B
   // 3  3
   // 1  1
@@ -499,8 +506,8 @@ TEST(CtmEnv_buildHalves0, Default_cotr) {
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::RIGHT].at("B")[3]));
   EXPECT_TRUE(hasindex(tt, ctmEnv.itaux[DIRECTION::LEFT].at("A")[3]));
 
-  ctmEnv.build_halves_V2(DIRECTION::DOWN, Vertex(1, 1), t,
-                         tt);  // direction down: t->left half, tt->right half
+  // direction down: t->left half, tt->right half
+  halves(DIRECTION::DOWN, Vertex(1, 1), t, tt);
   // B--2 0--A
   // |       |
   // D--2 0--C
@@ -582,13 +589,22 @@ TEST(CtmEnv_compute_IsometriesT4, Default_cotr) {
     EXPECT_TRUE(hasindex(pt, ctmEnv.itaux[direction].at(id_shifted)[dir1]));
   };
 
-  ctmEnv.compute_IsometriesT4(DIRECTION::LEFT, ip, ipt, P, Pt, accT);
+  // projectors of a single move, as computed by performMoves
+  auto isometriesT4 = [&](DIRECTION direction) {
+    std::vector<CtmEnv::CtmMove> moves(1);
+    moves[0].direction = direction;
+    moves[0].iso_type = CtmEnv::ISOMETRY_T4;
+    ctmEnv.computeIsometries(moves, accT);
+    ctmEnv.isometriesToMaps(moves[0], ip, ipt, P, Pt);
+  };
+
+  isometriesT4(DIRECTION::LEFT);
 
-  ctmEnv.compute_IsometriesT4(DIRECTION::UP, ip, ipt, P, Pt, accT);
+  isometriesT4(DIRECTION::UP);
 
-  ctmEnv.compute_IsometriesT4(DIRECTION::RIGHT, ip, ipt, P, Pt, accT);
+  isometriesT4(DIRECTION::RIGHT);
 
-  ctmEnv.compute_IsometriesT4(DIRECTION::DOWN, ip, ipt, P, Pt, accT);
+  isometriesT4(DIRECTION::DOWN);
 }
 
 TEST(CtmEnv_move_singleDirection, Default_cotr) {
@@ -605,7 +621,7 @@ TEST(CtmEnv_move_singleDirection, Default_cotr) {
 
   // consistency of indices of T_* tensors
   auto verifyIndicesT = [&ctmEnv](DIRECTION direction, std::string const& id) {
-    std::map<std::string, ITensor>* ptr_T;
+    CtmEnv::SiteTensorMap* ptr_T;
     switch (direction) {
       case DIRECTION::LEFT: {
         ptr_T = &ctmEnv.T_L;
@@ -624,7 +640,7 @@ TEST(CtmEnv_move_singleDirection, Default_cotr) {
         break;
       }
     }
-    std::map<std::string, ITensor> const& Taux = *ptr_T;
+    CtmEnv::SiteTensorMap const& Taux = *ptr_T;
 
     auto t = Taux.at(id);
     // get orthogonal directions
@@ -641,8 +657,8 @@ TEST(CtmEnv_move_singleDirection, Default_cotr) {
 
   // consistency of indices of C_* tensors
   auto verifyIndicesC = [&ctmEnv](DIRECTION direction, std::string const& id) {
-    std::map<std::string, ITensor>* ptr_C;
-    std::map<std::string, ITensor>* ptr_Ct;
+    CtmEnv::SiteTensorMap* ptr_C;
+    CtmEnv::SiteTensorMap* ptr_Ct;
     switch (direction) {
       case DIRECTION::LEFT: {
         ptr_C = &ctmEnv.C_LU;
@@ -665,8 +681,8 @@ TEST(CtmEnv_move_singleDirection, Default_cotr) {
         break;
       }
     }
-    std::map<std::string, ITensor> const& C = *ptr_C;
-    std::map<std::string, ITensor> const& Ct = *ptr_Ct;
+    CtmEnv::SiteTensorMap const& C = *ptr_C;
+    CtmEnv::SiteTensorMap const& Ct = *ptr_Ct;
 
     auto c = C.at(id);
     auto ct = Ct.at(id);
@@ -0,0 +1,666 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "pi-peps/cluster-ev-builder.h"
+#include "pi-peps/ctm-cluster-basic.h"
+#include "pi-peps/ctm-env.h"
+
+using namespace itensor;
+
+namespace {
+
+  // 2x2 cluster with four distinct random on-site tensors
+  std::unique_ptr<Cluster> randomCluster2x2(int ad, int pd) {
+    std::unique_ptr<Cluster> p_cls(new Cluster_2x2_ABCD("ZPRST", ad, pd));
+    for (auto& s : p_cls->sites)
+      s.second = randomTensor(s.second.inds());
+    p_cls->siteVersion++;
+    return p_cls;
+  }
+
+  // projectors of a single move, as computed by the current setting of
+  // ctmThreads
+  void projectors(CtmEnv const& env,
+                  CtmEnv::DIRECTION direction,
+                  CtmEnv::ISOMETRY iso_type,
+                  std::map<std::string, ITensor>& P,
+                  std::map<std::string, ITensor>& Pt) {
+    std::vector<CtmEnv::CtmMove> moves(1);
+    moves[0].direction = direction;
+    moves[0].iso_type = iso_type;
+    std::vector<double> accT(12, 0.0);
+    env.computeIsometries(moves, accT);
+
+    std::map<std::string, Index> ip, ipt;
+    env.isometriesToMaps(moves[0], ip, ipt, P, Pt);
+  }
+
+  // singular values of a corner, normalized by the largest one
+  std::vector<double> cornerSpectrum(ITensor const& C) {
+    auto i0 = C.inds()[0];
+    ITensor U(i0), S, V;
+    svd(C, U, S, V, {"Truncate", false});
+    std::vector<double> s;
+    for (int k = 1; k <= S.inds().front().m(); k++)
+      s.push_back(S.real(S.inds().front()(k), S.inds().back()(k)));
+    for (auto& e : s)
+      e /= s.front();
+    return s;
+  }
+
+  // C4v-symmetric single-site state close to a product state, hence with
+  // short correlation length and fast convergence of the environment
+  std::unique_ptr<Cluster> symmetricCluster1x1(int ad, int pd) {
+    std::unique_ptr<Cluster> p_cls(new Cluster_1x1_A("ZPRST", ad, pd));
+    auto& A = p_cls->sites.at("A");
+    A += 0.1 * randomTensor(A.inds());
+    p_cls->siteVersion++;
+    p_cls->symmetrizeC4v();
+    return p_cls;
+  }
+
+  // tr(rho^k)/tr(rho)^k for k = 2, 3 of the ring of corners
+  // rho = C_LU*C_RU*C_RD*C_LD of single-site environment, joined directly
+  // along the edges. Unlike the spectra of individual corners, these are
+  // invariant under the gauge of the environment
+  std::vector<double> ringMoments(CtmEnv const& env) {
+    auto const& ea = env.eaux[0];
+    auto rho = env.C_LU[0] * delta(ea[0], ea[1]);
+    rho *= env.C_RU[0];
+    rho *= delta(ea[2], ea[3]);
+    rho *= env.C_RD[0];
+    rho *= delta(ea[4], ea[5]);
+    rho *= env.C_LD[0];
+
+    auto a = Index("a", ea[7].m()), b = Index("b", ea[7].m()),
+         c = Index("c", ea[7].m());
+    auto mat = [&rho, &ea](Index const& i, Index const& j) {
+      return reindex(reindex(rho, ea[7], i), ea[6], j);
+    };
+    double tr1 = (mat(a, b) * delta(a, b)).real();
+    double tr2 = (mat(a, b) * mat(b, a)).real();
+    auto rho3 = mat(a, b) * mat(b, c);
+    double tr3 = (rho3 * mat(c, a)).real();
+    return {tr2 / std::pow(tr1, 2), tr3 / std::pow(tr1, 3)};
+  }
+
+  // all corner and half-row/column tensors of the environment
+  std::vector<CtmEnv::SiteTensorMap*> envMaps(CtmEnv& env) {
+    return {&env.C_LU, &env.C_RU, &env.C_RD, &env.C_LD,
+            &env.T_U,  &env.T_R,  &env.T_D,  &env.T_L};
+  }
+
+  std::vector<CtmEnv::SiteTensorMap> saveEnv(CtmEnv& env) {
+    std::vector<CtmEnv::SiteTensorMap> state;
+    for (auto const* m : envMaps(env))
+      state.push_back(*m);
+    return state;
+  }
+
+  void restoreEnv(CtmEnv& env,
+                  std::vector<CtmEnv::SiteTensorMap> const& state) {
+    auto maps = envMaps(env);
+    for (std::size_t k = 0; k < maps.size(); k++)
+      *maps[k] = state[k];
+  }
+
+}  // namespace
+
+// Projectors computed concurrently by several threads must coincide with
+// those of the serial computation. The index plumbing of every site is
+// shared through the plan of the move, hence the indices of P, Pt
+// coincide as well
+TEST(CtmEnvIsometries, ThreadsDeterministic) {
+  auto p_cls = randomCluster2x2(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_2x2_ABCD", 8, *p_cls, solver,
+             {"isoFixGauge", true, "SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_rnd, false, false);
+
+  double eps = 1.0e-10;
+  for (auto iso_type : {CtmEnv::ISOMETRY_T3, CtmEnv::ISOMETRY_T4}) {
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN}) {
+      std::map<std::string, ITensor> P1, Pt1, P4, Pt4;
+      env.ctmThreads = 1;
+      projectors(env, direction, iso_type, P1, Pt1);
+      env.ctmThreads = 4;
+      projectors(env, direction, iso_type, P4, Pt4);
+
+      for (auto const& id : p_cls->siteIds) {
+        EXPECT_TRUE(norm(P1.at(id) - P4.at(id)) < eps * norm(P1.at(id)))
+          << "iso_type " << iso_type << " direction " << direction
+          << " site " << id;
+        EXPECT_TRUE(norm(Pt1.at(id) - Pt4.at(id)) < eps * norm(Pt1.at(id)))
+          << "iso_type " << iso_type << " direction " << direction
+          << " site " << id;
+      }
+    }
+  }
+}
+
+// Symmetric CTM of a C4v-invariant single-site cluster must converge to
+// the same fixed point as the directional CTM. Compared are the gauge
+// invariant moments of the ring of corners and the energy of the
+// Heisenberg bonds
+TEST(CtmEnvC4v, MatchesDirectional) {
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  CtmEnv envC4v("TEST_1x1_A", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  CtmEnv envDir("TEST_1x1_A", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  envC4v.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  envDir.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  for (int i = 0; i < 60; i++) {
+    envC4v.move_c4v(accT);
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::RIGHT, CtmEnv::UP,
+                           CtmEnv::DOWN})
+      envDir.move_unidirectional(direction, CtmEnv::ISOMETRY_T3, accT);
+  }
+
+  auto mC4v = ringMoments(envC4v);
+  auto mDir = ringMoments(envDir);
+  for (int k = 0; k < 2; k++)
+    EXPECT_NEAR(mC4v[k], mDir[k], 1.0e-6) << "moment " << k + 2;
+
+  EVBuilder evC4v("c4v", *p_cls, envC4v);
+  EVBuilder evDir("dir", *p_cls, envDir);
+  for (auto const& v2 : {Vertex(1, 0), Vertex(0, 1)})
+    EXPECT_NEAR(evC4v.evalSS(Vertex(0, 0), v2),
+                evDir.evalSS(Vertex(0, 0), v2), 1.0e-6);
+}
+
+// Zero on-site tensor gives zero enlarged corner, which is rejected
+// instead of normalizing the corners by zero
+TEST(CtmEnvC4v, RejectsDegenerate) {
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_1x1_A", 4, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_const1, false, false);
+  p_cls->sites.at("A") *= 0.0;
+  p_cls->siteVersion++;
+
+  std::vector<double> accT(12, 0.0);
+  EXPECT_THROW(env.move_c4v(accT), std::runtime_error);
+}
+
+// Complex tensors are rejected by the symmetric CTM
+TEST(CtmEnvC4v, RejectsComplex) {
+  Cluster_1x1_A cls("ZPRST", 2, 2);
+  auto& A = cls.sites.at("A");
+  A = A + Cplx_i * randomTensor(A.inds());
+  cls.siteVersion++;
+
+  SvdSolver solver;
+  CtmEnv env("TEST_1x1_A", 4, cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_ctmrg, true, false);
+
+  std::vector<double> accT(12, 0.0);
+  EXPECT_THROW(env.move_c4v(accT), std::runtime_error);
+}
+
+// Checkpoint written by writeEnv is read back by initFromFile into an
+// environment of different x (within its chiMax). Indices are recreated,
+// hence the tensors are compared through their norms and the spectra of
+// the corners
+TEST(CtmEnvIO, RoundTrip) {
+  auto p_cls = randomCluster2x2(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_2x2_ABCD", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_rnd, false, false);
+  std::string const file = "test-ctmrg-roundtrip.env";
+  env.writeEnv(file);
+
+  CtmEnv envIn("TEST_2x2_ABCD", 4, *p_cls, solver,
+               {"SVD_METHOD", "itensor", "chiMax", 8});
+  envIn.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  envIn.initFromFile(file);
+  std::remove(file.c_str());
+
+  EXPECT_EQ(envIn.x, env.x);
+  double eps = 1.0e-12;
+  for (auto const& id : p_cls->siteIds) {
+    int const h = env.siteHandle(id);
+    for (int k = 0; k < 8; k++) {
+      EXPECT_EQ(envIn.eaux[h][k].rawname(), env.eaux[h][k].rawname());
+      EXPECT_EQ(envIn.eaux[h][k].m(), env.eaux[h][k].m());
+    }
+    for (auto e : {&CtmEnv::C_LU, &CtmEnv::C_RU, &CtmEnv::C_RD,
+                   &CtmEnv::C_LD, &CtmEnv::T_L, &CtmEnv::T_U, &CtmEnv::T_R,
+                   &CtmEnv::T_D})
+      EXPECT_NEAR(norm((envIn.*e)[h]), norm((env.*e)[h]),
+                  eps * norm((env.*e)[h]))
+        << "site " << id;
+
+    auto s = cornerSpectrum(env.C_LU[h]);
+    auto sIn = cornerSpectrum(envIn.C_LU[h]);
+    ASSERT_EQ(sIn.size(), s.size());
+    for (size_t k = 0; k < s.size(); k++)
+      EXPECT_NEAR(sIn[k], s[k], eps) << "site " << id;
+  }
+}
+
+// Checkpoint of x larger than configured is rejected, by INIT_ENV_file
+// above x and by initFromFile above chiMax, leaving the environment
+// untouched
+TEST(CtmEnvIO, RejectsLargerX) {
+  auto p_cls = randomCluster2x2(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_2x2_ABCD", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_rnd, false, false);
+  std::string const file = "test-ctmrg-larger.env";
+  env.writeEnv(file);
+
+  CtmEnv envIn("TEST_2x2_ABCD", 4, *p_cls, solver,
+               {"SVD_METHOD", "itensor", "chiMax", 6, "envFile", file});
+  envIn.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  auto const C_LU = envIn.C_LU;
+  EXPECT_THROW(envIn.init(CtmEnv::INIT_ENV_file, false, false),
+               std::runtime_error);
+  EXPECT_THROW(envIn.initFromFile(file), std::runtime_error);
+  std::remove(file.c_str());
+
+  EXPECT_EQ(envIn.x, 4);
+  EXPECT_EQ(envIn.chiMax, 6);
+  for (auto const& id : p_cls->siteIds) {
+    int const h = envIn.siteHandle(id);
+    EXPECT_TRUE(norm(envIn.C_LU[h] - C_LU[h]) == 0.0) << "site " << id;
+  }
+}
+
+// Failure on a truncated checkpoint leaves the environment untouched
+TEST(CtmEnvIO, TruncatedFile) {
+  auto p_cls = randomCluster2x2(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_2x2_ABCD", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_rnd, false, false);
+  std::string const file = "test-ctmrg-truncated.env";
+  env.writeEnv(file);
+  {
+    std::ifstream in(file, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size() / 2);
+  }
+
+  CtmEnv envIn("TEST_2x2_ABCD", 4, *p_cls, solver,
+               {"SVD_METHOD", "itensor", "chiMax", 8});
+  envIn.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  auto const eaux = envIn.eaux;
+  auto const C_LU = envIn.C_LU;
+  auto const T_L = envIn.T_L;
+
+  EXPECT_THROW(envIn.initFromFile(file), std::runtime_error);
+  std::remove(file.c_str());
+
+  EXPECT_EQ(envIn.x, 4);
+  for (auto const& id : p_cls->siteIds) {
+    int const h = envIn.siteHandle(id);
+    for (int k = 0; k < 8; k++)
+      EXPECT_TRUE(envIn.eaux[h][k] == eaux[h][k]) << "site " << id;
+    EXPECT_TRUE(norm(envIn.C_LU[h] - C_LU[h]) == 0.0) << "site " << id;
+    EXPECT_TRUE(norm(envIn.T_L[h] - T_L[h]) == 0.0) << "site " << id;
+  }
+}
+
+// VUMPS and directional CTM must converge to the same environment of a
+// C4v-symmetric single-site state. Compared are the gauge invariant
+// moments of the ring of corners, which verify the fixed points of the
+// corners together with the absorbed gauge matrices C, and the energy of
+// the Heisenberg bonds
+TEST(CtmEnvVumps, MatchesDirectional) {
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  CtmEnv envVumps("TEST_1x1_A", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  CtmEnv envDir("TEST_1x1_A", 8, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  envVumps.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  envDir.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  for (int i = 0; i < 60; i++) {
+    envVumps.move_vumps(accT);
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::RIGHT, CtmEnv::UP,
+                           CtmEnv::DOWN})
+      envDir.move_unidirectional(direction, CtmEnv::ISOMETRY_T3, accT);
+  }
+  for (auto const& e : envVumps.vumpsErr)
+    EXPECT_LT(e, 1.0e-8);
+
+  auto mVumps = ringMoments(envVumps);
+  auto mDir = ringMoments(envDir);
+  for (int k = 0; k < 2; k++)
+    EXPECT_NEAR(mVumps[k], mDir[k], 1.0e-6) << "moment " << k + 2;
+
+  EVBuilder evVumps("vumps", *p_cls, envVumps);
+  EVBuilder evDir("dir", *p_cls, envDir);
+  for (auto const& v2 : {Vertex(1, 0), Vertex(0, 1)})
+    EXPECT_NEAR(evVumps.evalSS(Vertex(0, 0), v2),
+                evDir.evalSS(Vertex(0, 0), v2), 1.0e-6);
+}
+
+// Layer by layer absorption of on-site tensors must reproduce the
+// contractions with the double-layer tensor up to round-off: enlarged
+// corners, halves, and a full move (projectors and absorption into C, T)
+// for each type of isometry
+TEST(CtmEnvLayered, MatchesDoubleLayer) {
+  auto p_cls = randomCluster2x2(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_2x2_ABCD", 8, *p_cls, solver,
+             {"isoFixGauge", true, "SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_rnd, false, false);
+
+  double eps = 1.0e-10;
+  auto close = [eps](ITensor const& a, ITensor const& b) {
+    return norm(a - b) < eps * norm(a);
+  };
+
+  for (auto const& id : p_cls->siteIds) {
+    auto const& v = p_cls->idToV.at(id);
+    for (auto corner : {CtmEnv::LU, CtmEnv::RU, CtmEnv::RD, CtmEnv::LD}) {
+      env.layeredContraction = false;
+      auto C2 = env.build_corner_V2(corner, v);
+      env.layeredContraction = true;
+      auto C1 = env.build_corner_V2(corner, v);
+      EXPECT_TRUE(close(C2, C1)) << "corner " << corner << " site " << id;
+    }
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN}) {
+      auto cmb = env.build_halves_combiners(direction, v);
+      ITensor H2, Ht2, H1, Ht1;
+      env.layeredContraction = false;
+      env.build_halves_V2(direction, v, cmb, H2, Ht2);
+      env.layeredContraction = true;
+      env.build_halves_V2(direction, v, cmb, H1, Ht1);
+      EXPECT_TRUE(close(H2, H1)) << "direction " << direction << " site "
+                                 << id;
+      EXPECT_TRUE(close(Ht2, Ht1)) << "direction " << direction << " site "
+                                   << id;
+    }
+  }
+
+  std::vector<double> accT(12, 0.0);
+  auto const initial = saveEnv(env);
+  for (auto iso_type : {CtmEnv::ISOMETRY_T3, CtmEnv::ISOMETRY_T4}) {
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN}) {
+      restoreEnv(env, initial);
+      env.layeredContraction = false;
+      env.move_singleDirection(direction, iso_type, accT);
+      auto const doubleLayer = saveEnv(env);
+
+      restoreEnv(env, initial);
+      env.layeredContraction = true;
+      env.move_singleDirection(direction, iso_type, accT);
+      auto const layered = saveEnv(env);
+
+      for (std::size_t k = 0; k < layered.size(); k++) {
+        for (auto const& id : p_cls->siteIds) {
+          EXPECT_TRUE(close(doubleLayer[k].at(id), layered[k].at(id)))
+            << "iso_type " << iso_type << " direction " << direction
+            << " tensor " << k << " site " << id;
+        }
+      }
+    }
+  }
+}
+
+// The sweep updates opposite directions from the same environment, which
+// changes the iteration but not its fixed point. Compared to the moves
+// L,U,R,D performed one after another are the spectra of the projectors
+// and the energy of the Heisenberg bonds. A single sweep must not depend
+// on ctmThreads
+TEST(CtmEnvSweep, MatchesSequential) {
+  std::unique_ptr<Cluster> p_cls(new Cluster_2x2_ABCD("ZPRST", 2, 2));
+  for (auto& s : p_cls->sites)
+    s.second += 0.1 * randomTensor(s.second.inds());
+  p_cls->siteVersion++;
+
+  SvdSolver solver;
+  Args args = {"isoFixGauge", true, "SVD_METHOD", "itensor"};
+  CtmEnv envSweep("TEST_2x2_ABCD", 8, *p_cls, solver, args);
+  CtmEnv envSeq("TEST_2x2_ABCD", 8, *p_cls, solver, args);
+  envSweep.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+  envSeq.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  auto const initial = saveEnv(envSweep);
+  envSweep.ctmThreads = 1;
+  envSweep.sweep(CtmEnv::ISOMETRY_T3, accT);
+  auto const serial = saveEnv(envSweep);
+  restoreEnv(envSweep, initial);
+  envSweep.ctmThreads = 4;
+  envSweep.sweep(CtmEnv::ISOMETRY_T3, accT);
+  auto const threaded = saveEnv(envSweep);
+  for (std::size_t k = 0; k < serial.size(); k++) {
+    for (auto const& id : p_cls->siteIds) {
+      EXPECT_TRUE(norm(serial[k].at(id) - threaded[k].at(id)) <
+                  1.0e-12 * norm(serial[k].at(id)))
+        << "tensor " << k << " site " << id;
+    }
+  }
+
+  for (int i = 1; i < 60; i++)
+    envSweep.sweep(CtmEnv::ISOMETRY_T3, accT);
+  for (int i = 0; i < 60; i++) {
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN})
+      envSeq.move_unidirectional(direction, CtmEnv::ISOMETRY_T3, accT);
+  }
+
+  for (int d = 0; d < 4; d++) {
+    for (std::size_t h = 0; h < p_cls->siteIds.size(); h++) {
+      auto const& s1 = envSweep.spec.sv[d][h];
+      auto const& s2 = envSeq.spec.sv[d][h];
+      ASSERT_EQ(s1.size(), s2.size());
+      for (std::size_t k = 0; k < s1.size(); k++)
+        EXPECT_NEAR(s1[k], s2[k], 1.0e-6)
+          << "direction " << d << " site " << p_cls->siteIds[h];
+    }
+  }
+
+  EVBuilder evSweep("sweep", *p_cls, envSweep);
+  EVBuilder evSeq("seq", *p_cls, envSeq);
+  for (auto const& v : {Vertex(0, 0), Vertex(1, 1)}) {
+    for (auto const& v2 : {v + Shift(1, 0), v + Shift(0, 1)})
+      EXPECT_NEAR(evSweep.evalSS(v, v2), evSeq.evalSS(v, v2), 1.0e-6);
+  }
+}
+
+// Once the projectors of a direction are stable, the following moves in
+// that direction reuse them: no projectors are computed (isoComputed stays
+// put, isoSkipped grows) and specDist reports no measurement (-1)
+TEST(CtmEnvIsoReuse, SkipsProjectors) {
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_1x1_A", 8, *p_cls, solver,
+             {"isoFixGauge", true, "SVD_METHOD", "itensor", "isoReuseTol",
+              1.0e-4, "isoReuseMax", 2});
+  env.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  auto const directions = {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN};
+  // converge until the first reuse
+  int i = 0;
+  for (; i < 100 && env.isoSkipped == 0; i++) {
+    auto prev = env.spec;
+    for (auto direction : directions)
+      env.move_singleDirection(direction, CtmEnv::ISOMETRY_T3, accT);
+    if (env.isoSkipped == 0) {
+      EXPECT_GE(env.specDist(env.spec, prev), 0.0);
+    } else {
+      EXPECT_EQ(env.specDist(env.spec, prev), -1.0);
+    }
+  }
+  ASSERT_GT(env.isoSkipped, 0) << "no reuse within " << i << " sweeps";
+
+  // a reusing move neither computes projectors nor measures spectra, and
+  // at most isoReuseMax moves in a row reuse
+  int reusedInRow = 0;
+  for (int k = 0; k < 8; k++) {
+    long const computed = env.isoComputed;
+    long const skipped = env.isoSkipped;
+    env.move_singleDirection(CtmEnv::LEFT, CtmEnv::ISOMETRY_T3, accT);
+    if (env.spec.reused[CtmEnv::LEFT]) {
+      EXPECT_EQ(env.isoComputed, computed);
+      EXPECT_EQ(env.isoSkipped, skipped + 1);
+      reusedInRow++;
+      EXPECT_LE(reusedInRow, env.isoReuseMax);
+    } else {
+      EXPECT_EQ(env.isoComputed, computed + 1);
+      EXPECT_EQ(env.isoSkipped, skipped);
+      reusedInRow = 0;
+    }
+  }
+}
+
+// Anderson extrapolation of the sweeps must reach the fixed point of plain
+// CTM, in fewer iterations. The state is far from a product state, hence
+// plain CTM converges slowly
+TEST(CtmEnvAnderson, FasterToSameFixedPoint) {
+  std::unique_ptr<Cluster> p_cls(new Cluster_1x1_A("ZPRST", 2, 2));
+  auto& A = p_cls->sites.at("A");
+  A = randomTensor(A.inds());
+  p_cls->siteVersion++;
+  p_cls->symmetrizeC4v();
+
+  SvdSolver solver;
+  CtmEnv envPlain("TEST_1x1_A", 8, *p_cls, solver,
+                  {"isoFixGauge", true, "SVD_METHOD", "itensor"});
+  CtmEnv envAnd("TEST_1x1_A", 8, *p_cls, solver,
+                {"isoFixGauge", true, "SVD_METHOD", "itensor",
+                 "andersonDepth", 4});
+
+  // number of iterations until the residual of a sweep drops below tol
+  double const tol = 1.0e-9;
+  int const maxIter = 1000;
+  std::vector<double> accT(12, 0.0);
+  auto converge = [&](CtmEnv& env) {
+    env.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+    for (int i = 1; i <= maxIter; i++) {
+      for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                             CtmEnv::DOWN})
+        env.move_singleDirection(direction, CtmEnv::ISOMETRY_T3, accT);
+      double res = env.extrapolate();
+      if (res >= 0.0 && res < tol)
+        return i;
+    }
+    return maxIter + 1;
+  };
+  int const itPlain = converge(envPlain);
+  int const itAnd = converge(envAnd);
+  ASSERT_LE(itPlain, maxIter);
+  EXPECT_LT(itAnd, itPlain);
+
+  auto mPlain = ringMoments(envPlain);
+  auto mAnd = ringMoments(envAnd);
+  for (int k = 0; k < 2; k++)
+    EXPECT_NEAR(mPlain[k], mAnd[k], 1.0e-6) << "moment " << k + 2;
+
+  EVBuilder evPlain("plain", *p_cls, envPlain);
+  EVBuilder evAnd("anderson", *p_cls, envAnd);
+  for (auto const& v2 : {Vertex(1, 0), Vertex(0, 1)})
+    EXPECT_NEAR(evPlain.evalSS(Vertex(0, 0), v2),
+                evAnd.evalSS(Vertex(0, 0), v2), 1.0e-6);
+}
+
+// Growing x by zero padding (no noise) embeds the environment without
+// changing it: the gauge invariant moments and bond energies stay the
+// same, the next move reproduces the leading part of the spectrum at the
+// previous x, and the discarded weight of the previous x is forgotten
+TEST(CtmEnvGrowChi, KeepsSpectrum) {
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  CtmEnv env("TEST_1x1_A", 4, *p_cls, solver, {"SVD_METHOD", "itensor"});
+  env.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  for (int i = 0; i < 40; i++) {
+    for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                           CtmEnv::DOWN})
+      env.move_singleDirection(direction, CtmEnv::ISOMETRY_T3, accT);
+  }
+  auto const m4 = ringMoments(env);
+  EVBuilder ev4("x4", *p_cls, env);
+  double const e4 = ev4.evalSS(Vertex(0, 0), Vertex(1, 0));
+
+  auto const state = saveEnv(env);
+  env.move_singleDirection(CtmEnv::LEFT, CtmEnv::ISOMETRY_T3, accT);
+  auto const sv4 = env.spec.sv[CtmEnv::LEFT][0];
+  restoreEnv(env, state);
+  ASSERT_GT(env.isoTruncErr[CtmEnv::LEFT], 0.0);
+
+  env.growChi(8, 0.0);
+  EXPECT_EQ(env.x, 8);
+  for (double e : env.isoTruncErr)
+    EXPECT_EQ(e, 0.0);
+
+  auto const m8 = ringMoments(env);
+  for (int k = 0; k < 2; k++)
+    EXPECT_NEAR(m4[k], m8[k], 1.0e-12) << "moment " << k + 2;
+  EVBuilder ev8("x8", *p_cls, env);
+  EXPECT_NEAR(ev8.evalSS(Vertex(0, 0), Vertex(1, 0)), e4, 1.0e-12);
+
+  env.move_singleDirection(CtmEnv::LEFT, CtmEnv::ISOMETRY_T3, accT);
+  auto const& sv8 = env.spec.sv[CtmEnv::LEFT][0];
+  ASSERT_GE(sv8.size(), sv4.size());
+  for (std::size_t k = 0; k < sv4.size(); k++)
+    EXPECT_NEAR(sv8[k], sv4[k], 1.0e-10) << "singular value " << k;
+}
+
+// The reduced-accuracy phase is accepted only for registered solvers whose
+// work depends on the lowered tolerance or number of power iterations.
+// Dense solvers, including the auto-tuned one which may pick any of them,
+// are rejected
+TEST(CtmEnvLowPrecision, RejectsDenseSolvers) {
+  for (auto const& m : {"default", "itensor", "gesdd", "gesdd-pool", "gesvd",
+                        "gejsv", "auto"})
+    EXPECT_FALSE(supportsLowPrecision(m)) << m;
+  for (auto const& m : {"warmstart", "rsvd", "rsvd-lapack", "lanczos",
+                        "arpack"})
+    EXPECT_TRUE(supportsLowPrecision(m)) << m;
+  EXPECT_FALSE(supportsLowPrecision("unknown"));
+}
+
+// The chi ladder ends at the requested x, appended if the rungs stop
+// short of it. Growing the environment along the ladder, with CTM moves at
+// each rung, reaches exactly that x
+TEST(CtmEnvChiLadder, EndsAtRequestedX) {
+  EXPECT_EQ(makeChiLadder({4, 8}, 12), std::vector<int>({4, 8, 12}));
+  EXPECT_EQ(makeChiLadder({4, 12}, 12), std::vector<int>({4, 12}));
+  EXPECT_EQ(makeChiLadder({}, 12), std::vector<int>({12}));
+  EXPECT_THROW(makeChiLadder({4, 16}, 12), std::runtime_error);
+  EXPECT_THROW(makeChiLadder({8, 4}, 12), std::runtime_error);
+
+  auto p_cls = symmetricCluster1x1(2, 2);
+  SvdSolver solver;
+  auto const ladder = makeChiLadder({4, 8}, 12);
+  CtmEnv env("TEST_1x1_A", ladder.front(), *p_cls, solver,
+             {"SVD_METHOD", "itensor", "chiMax", ladder.back()});
+  env.init(CtmEnv::INIT_ENV_ctmrg, false, false);
+
+  std::vector<double> accT(12, 0.0);
+  for (std::size_t rung = 0; rung < ladder.size(); rung++) {
+    if (rung > 0)
+      env.growChi(ladder[rung], 1.0e-3);
+    EXPECT_EQ(env.x, ladder[rung]);
+    for (int i = 0; i < 5; i++) {
+      for (auto direction : {CtmEnv::LEFT, CtmEnv::UP, CtmEnv::RIGHT,
+                             CtmEnv::DOWN})
+        env.move_singleDirection(direction, CtmEnv::ISOMETRY_T3, accT);
+    }
+  }
+  EXPECT_EQ(env.x, 12);
+  EXPECT_EQ(env.eaux[0][0].m(), 12);
+}
@@ -0,0 +1,98 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <iostream>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/iterative-linsys-solvers.h"
+#include "pi-peps/linsyssolver-factory.h"
+
+using namespace itensor;
+
+namespace {
+
+  // hermitian A(i,i') = R R^dag + shift, positive definite for shift > 0
+  ITensor hermitian(Index const& i, bool cplx, double shift) {
+    Index j("j", i.m());
+    auto ip = prime(i);
+    auto R = cplx ? randomTensorC(i, j) : randomTensor(i, j);
+    ITensor A = R * dag(prime(R, i));
+    for (int k = 1; k <= i.m(); k++) {
+      if (cplx)
+        A.set(i(k), ip(k), A.cplx(i(k), ip(k)) + shift);
+      else
+        A.set(i(k), ip(k), A.real(i(k), ip(k)) + shift);
+    }
+    return A;
+  }
+
+  void checkMatFree(LinSysSolver const& solver, bool cplx, double shift) {
+    double eps = 1.0e-08;
+    Index i("i", 30);
+    auto A = hermitian(i, cplx, shift);
+    auto B = cplx ? randomTensorC(prime(i)) : randomTensor(prime(i));
+    auto applyA = [&A](ITensor const& x) { return A * x; };
+    Args args = {"linsysTol", 1.0e-12};
+
+    ITensor X;
+    linsystemMatFree(applyA, B, X, 1, solver, args);
+    EXPECT_TRUE(hasindex(X, i));
+    EXPECT_TRUE(norm(A * X - B) < eps * norm(B));
+
+    // warm start from the solution
+    auto X0 = X;
+    linsystemMatFree(applyA, B, X, 1, solver, args);
+    EXPECT_TRUE(norm(X - X0) < eps * norm(X0));
+  }
+
+  void checkDense(LinSysSolver const& solver, bool cplx) {
+    double eps = 1.0e-08;
+    Index i("i", 20);
+    auto A = hermitian(i, cplx, 1.0);
+    auto B = cplx ? randomTensorC(i) : randomTensor(i);
+
+    ITensor X(prime(i));
+    linsystem(A, B, X, solver, {"linsysTol", 1.0e-12});
+    EXPECT_TRUE(norm(A * X - B) < eps * norm(B));
+  }
+
+}  // namespace
+
+TEST(LinearSystemCG, MatFree) {
+  CGSolver solver;
+  checkMatFree(solver, false, 1.0);
+  checkMatFree(solver, true, 1.0);
+}
+
+TEST(LinearSystemCG, Dense) {
+  CGSolver solver;
+  checkDense(solver, false);
+  checkDense(solver, true);
+}
+
+TEST(LinearSystemMinres, MatFree) {
+  MinresSolver solver;
+  checkMatFree(solver, false, 1.0);
+  checkMatFree(solver, true, 1.0);
+}
+
+// shifted spectrum of R R^dag, A is indefinite
+TEST(LinearSystemMinres, Indefinite) {
+  MinresSolver solver;
+  checkMatFree(solver, false, -0.5 * 30);
+}
+
+TEST(LinearSystemMinres, Dense) {
+  MinresSolver solver;
+  checkDense(solver, false);
+  checkDense(solver, true);
+}
+
+TEST(LinSysSolverFactory, Create) {
+  LinSysSolverFactory lsf = LinSysSolverFactory();
+  for (auto const& name : {"pseudoinverse", "cholesky", "cg", "minres"})
+    EXPECT_TRUE(lsf.create(name) != nullptr);
+  EXPECT_TRUE(lsf.create("cg")->matrixFree());
+  EXPECT_FALSE(lsf.create("cholesky")->matrixFree());
+  EXPECT_THROW(lsf.create("unknown"), std::runtime_error);
+}
@@ -0,0 +1,110 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <iostream>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/krylov-solvers.h"
+
+using namespace itensor;
+
+// Dense column-major operator y <- A x
+struct DenseVecProd {
+  int N;
+  std::vector<double> A;
+
+  void operator()(double const* const x, double* const y) {
+    for (int r = 0; r < N; r++) {
+      y[r] = 0.0;
+      for (int c = 0; c < N; c++)
+        y[r] += A[c * N + r] * x[c];
+    }
+  }
+};
+
+// Upper triangular operator with known spectrum, including a complex
+// conjugate pair 0.9 +- 0.3i from the leading 2x2 rotation block
+TEST(ArnoldiEigReal0, Default_cotr) {
+  double eps = 1.0e-08;
+  int N = 80;
+  DenseVecProd op{N, std::vector<double>(N * N, 0.0)};
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> dist(-0.1, 0.1);
+  for (int c = 0; c < N; c++)
+    for (int r = 0; r < c; r++)
+      op.A[c * N + r] = dist(rng);
+  op.A[0] = 0.9;
+  op.A[N + 1] = 0.9;
+  op.A[N] = 0.3;
+  op.A[1] = -0.3;
+  for (int d = 2; d < N; d++)
+    op.A[d * N + d] = 0.8 / d;
+
+  ArnoldiEig<DenseVecProd> arnoldi(op);
+  std::vector<std::complex<double>> ev, X;
+  int nconv = arnoldi.real_nonsymm(N, 4, 20, 1.0e-12, 100, ev, X, true);
+
+  ASSERT_EQ(nconv, 4);
+  EXPECT_NEAR(std::abs(ev[0]), std::hypot(0.9, 0.3), eps);
+  EXPECT_NEAR(std::abs(ev[1]), std::hypot(0.9, 0.3), eps);
+  EXPECT_NEAR(ev[0].real(), 0.9, eps);
+  EXPECT_NEAR(std::abs(ev[0].imag()), 0.3, eps);
+  EXPECT_NEAR(ev[2].real(), 0.4, eps);
+  EXPECT_NEAR(ev[3].real(), 0.8 / 3, eps);
+
+  // residual of the Ritz vectors
+  for (int s = 0; s < 4; s++) {
+    std::vector<double> re(N), im(N), Are(N), Aim(N);
+    for (int i = 0; i < N; i++) {
+      re[i] = X[s * N + i].real();
+      im[i] = X[s * N + i].imag();
+    }
+    op(re.data(), Are.data());
+    op(im.data(), Aim.data());
+    double res = 0.0;
+    for (int i = 0; i < N; i++)
+      res += std::norm(std::complex<double>(Are[i], Aim[i]) -
+                       ev[s] * X[s * N + i]);
+    EXPECT_LT(std::sqrt(res), eps);
+  }
+}
+
+// Leading singular values of a generic real matrix
+TEST(SvdLanczosReal0, Default_cotr) {
+  double eps = 1.0e-08;
+  int maxm = 6;
+  Index i("i", 70), j("j", 50), l("l", 50);
+  auto T = randomTensor(i, l) * randomTensor(l, j);
+
+  SvdSolver ref_solver = SvdSolver();
+  ITensor Ur(i), Dr, Vr;
+  svd(T, Ur, Dr, Vr, ref_solver, {"Maxm", maxm});
+
+  LanczosSvdSolver solver = LanczosSvdSolver();
+  ITensor U(i), D, V;
+  svd(T, U, D, V, solver, {"Maxm", maxm, "lanczos_svd_ncv", 16});
+
+  auto ld = commonIndex(U, D);
+  auto ldr = commonIndex(Ur, Dr);
+  ASSERT_EQ(ld.m(), ldr.m());
+  for (int s = 1; s <= ld.m(); s++) {
+    auto ldp = commonIndex(D, V);
+    auto ldrp = commonIndex(Dr, Vr);
+    EXPECT_NEAR(D.real(ld(s), ldp(s)), Dr.real(ldr(s), ldrp(s)),
+                eps * Dr.real(ldr(1), ldrp(1)));
+  }
+  EXPECT_TRUE(norm(Ur * Dr * Vr - U * D * V) < eps * norm(T));
+}
+
+// Maxm exceeding half of the rank falls back to full decomposition
+TEST(SvdLanczosReal1, Default_cotr) {
+  double eps = 1.0e-08;
+  Index i("i", 6), j("j", 4), k("k", 5);
+  auto T = randomTensor(i, j, k);
+
+  LanczosSvdSolver solver = LanczosSvdSolver();
+  ITensor U(i, j), D, V;
+  svd(T, U, D, V, solver, {"Truncate", false});
+
+  EXPECT_TRUE(norm(T - U * D * V) < eps);
+}
@@ -0,0 +1,81 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <iostream>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/lapack-pooled-svd-solver.h"
+
+using namespace itensor;
+
+namespace {
+
+  void checkDecomposition(LapackSvdSolver::DRIVER driver, bool cplx) {
+    double eps = 1.0e-08;
+    Index i("i", 7), j("j", 4), k("k", 3);
+
+    // wide, tall and repeated shapes (the latter reuse pooled workspace)
+    for (int rep = 0; rep < 2; rep++) {
+      auto T = cplx ? randomTensorC(i, j, k) : randomTensor(i, j, k);
+
+      LapackSvdSolver solver(driver);
+      ITensor U(i), D, V;
+      svd(T, U, D, V, solver, {"Truncate", false});
+      EXPECT_TRUE(norm(T - U * D * V) < eps * norm(T));
+
+      ITensor U2(j, k), D2, V2;
+      svd(T, U2, D2, V2, solver, {"Truncate", false});
+      EXPECT_TRUE(norm(T - U2 * D2 * V2) < eps * norm(T));
+    }
+  }
+
+}  // namespace
+
+TEST(SvdLapackPooledReal, Gesdd) {
+  checkDecomposition(LapackSvdSolver::GESDD, false);
+}
+
+TEST(SvdLapackPooledReal, Gesvd) {
+  checkDecomposition(LapackSvdSolver::GESVD, false);
+}
+
+TEST(SvdLapackPooledReal, Gejsv) {
+  checkDecomposition(LapackSvdSolver::GEJSV, false);
+}
+
+TEST(SvdLapackPooledCplx, Gesdd) {
+  checkDecomposition(LapackSvdSolver::GESDD, true);
+}
+
+TEST(SvdLapackPooledCplx, Gesvd) {
+  checkDecomposition(LapackSvdSolver::GESVD, true);
+}
+
+// dgejsv is real only, complex matrices are passed to zgesvd
+TEST(SvdLapackPooledCplx, Gejsv) {
+  checkDecomposition(LapackSvdSolver::GEJSV, true);
+}
+
+// singular values agree with the default solver
+TEST(SvdLapackPooledReal, Spectrum) {
+  Index i("i", 20), j("j", 12);
+  auto T = randomTensor(i, j);
+
+  SvdSolver ref_solver = SvdSolver();
+  ITensor Ur(i), Dr, Vr;
+  svd(T, Ur, Dr, Vr, ref_solver, {"Truncate", false});
+  auto lr = commonIndex(Ur, Dr);
+  auto lrp = commonIndex(Dr, Vr);
+
+  for (auto driver : {LapackSvdSolver::GESDD, LapackSvdSolver::GESVD,
+                      LapackSvdSolver::GEJSV}) {
+    LapackSvdSolver solver(driver);
+    ITensor U(i), D, V;
+    svd(T, U, D, V, solver, {"Truncate", false});
+    auto l = commonIndex(U, D);
+    auto lp = commonIndex(D, V);
+    ASSERT_EQ(l.m(), lr.m());
+    for (int s = 1; s <= l.m(); s++)
+      EXPECT_NEAR(D.real(l(s), lp(s)), Dr.real(lr(s), lrp(s)), 1.0e-10);
+  }
+}
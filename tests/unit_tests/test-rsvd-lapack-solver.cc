@@ -0,0 +1,87 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <iostream>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/rsvd-lapack-solver.h"
+
+using namespace itensor;
+
+// Sampled subspace covering the whole matrix, falls back to full
+// decomposition
+TEST(SvdRandomizedReal0, Default_cotr) {
+  double eps = 1.0e-08;
+  Index i("i", 6), j("j", 4), k("k", 5);
+  auto T = randomTensor(i, j, k);
+
+  RandomizedSvdSolver solver = RandomizedSvdSolver();
+  ITensor U(i, j), D, V;
+  svd(T, U, D, V, solver, {"Truncate", false});
+
+  EXPECT_TRUE(norm(T - U * D * V) < eps);
+}
+
+// Leading singular values of a matrix of low rank
+TEST(SvdRandomizedReal1, Default_cotr) {
+  double eps = 1.0e-08;
+  int maxm = 4;
+  Index i("i", 60), j("j", 40), l("l", 8);
+  auto T = randomTensor(i, l) * randomTensor(l, j);
+
+  SvdSolver ref_solver = SvdSolver();
+  ITensor Ur(i), Dr, Vr;
+  svd(T, Ur, Dr, Vr, ref_solver, {"Maxm", maxm});
+
+  RandomizedSvdSolver solver = RandomizedSvdSolver();
+  ITensor U(i), D, V;
+  svd(T, U, D, V, solver,
+      {"Maxm", maxm, "rsvd_oversampling", 6, "rsvd_power", 2});
+
+  auto ld = commonIndex(U, D);
+  auto ldr = commonIndex(Ur, Dr);
+  ASSERT_EQ(ld.m(), ldr.m());
+  for (int s = 1; s <= ld.m(); s++) {
+    auto ldp = commonIndex(D, V);
+    auto ldrp = commonIndex(Dr, Vr);
+    EXPECT_NEAR(D.real(ld(s), ldp(s)), Dr.real(ldr(s), ldrp(s)),
+                eps * Dr.real(ldr(1), ldrp(1)));
+  }
+}
+
+// Complex matrix of low rank, no intermediate re-orthonormalization
+TEST(SvdRandomizedCplx0, Default_cotr) {
+  double eps = 1.0e-08;
+  int maxm = 5;
+  Index i("i", 50), j("j", 50), l("l", 5);
+  auto T = randomTensorC(i, l) * randomTensorC(l, j);
+
+  RandomizedSvdSolver solver = RandomizedSvdSolver();
+  ITensor U(i), D, V;
+  svd(T, U, D, V, solver,
+      {"Maxm", maxm, "rsvd_oversampling", 5, "rsvd_reortho", 0});
+
+  EXPECT_TRUE(norm(T - U * D * V) < eps * norm(T));
+}
+
+// The sketch is fixed by "svd_seed" and the shape of the matrix, so repeated
+// decompositions agree exactly, whatever was computed in between
+TEST(SvdRandomizedReal2, Seeded) {
+  int maxm = 4;
+  Index i("i", 30), j("j", 20);
+  auto T = randomTensor(i, j);
+  auto T2 = randomTensor(i, j);
+  Args args = {"Maxm", maxm, "rsvd_power", 0, "svd_seed", 7};
+
+  RandomizedSvdSolver solver = RandomizedSvdSolver();
+  ITensor U1(i), D1, V1, U2(i), D2, V2, U3(i), D3, V3;
+  svd(T, U1, D1, V1, solver, args);
+  svd(T2, U3, D3, V3, solver, args);
+  svd(T, U2, D2, V2, solver, args);
+
+  auto l1 = commonIndex(U1, D1), l1p = commonIndex(D1, V1);
+  auto l2 = commonIndex(U2, D2), l2p = commonIndex(D2, V2);
+  ASSERT_EQ(l1.m(), l2.m());
+  for (int s = 1; s <= l1.m(); s++)
+    EXPECT_EQ(D1.real(l1(s), l1p(s)), D2.real(l2(s), l2p(s)));
+}
@@ -0,0 +1,48 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "pi-peps/site-map.h"
+
+// Handles follow the order of ids, both views address the same element
+TEST(SiteMapAccess, Default_cotr) {
+  SiteMap<int> m({"A", "B", "C"});
+
+  EXPECT_EQ(m.size(), 3u);
+  EXPECT_EQ(m.handle("A"), 0);
+  EXPECT_EQ(m.handle("C"), 2);
+
+  m["B"] = 7;
+  EXPECT_EQ(m[1], 7);
+  m[2] = 3;
+  EXPECT_EQ(m.at("C"), 3);
+
+  EXPECT_THROW(m.at("D"), std::out_of_range);
+  EXPECT_THROW(m.at(3), std::out_of_range);
+}
+
+// Inserting new id does not alter the layout shared with other containers
+TEST(SiteMapInsert, Default_cotr) {
+  SiteMap<int> m({"A", "B"});
+  SiteMap<int> n(m.layout());
+
+  m["D"] = 1;
+  EXPECT_EQ(m.size(), 3u);
+  EXPECT_EQ(m.handle("D"), 2);
+  EXPECT_EQ(n.size(), 2u);
+  EXPECT_EQ(n.count("D"), 0u);
+}
+
+// Containers of the same layout exchange their contents
+TEST(SiteMapSwap, Default_cotr) {
+  SiteMap<int> m({"A", "B"});
+  SiteMap<int> n(m.layout());
+  m["A"] = 1;
+  m["B"] = 2;
+  n["A"] = 3;
+  n["B"] = 4;
+
+  m.swap(n);
+  EXPECT_EQ(m.at("A"), 3);
+  EXPECT_EQ(n.at("B"), 2);
+  EXPECT_EQ(m.layout(), n.layout());
+}
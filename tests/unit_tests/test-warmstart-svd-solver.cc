@@ -0,0 +1,79 @@
+#include "pi-peps/config.h"
+#include <gtest/gtest.h>
+#include <iostream>
+DISABLE_WARNINGS
+#include "itensor/all.h"
+ENABLE_WARNINGS
+#include "pi-peps/linalg/warmstart-svd-solver.h"
+
+using namespace itensor;
+
+// Without a guess the solver performs full decomposition
+TEST(SvdWarmStartReal0, Default_cotr) {
+  double eps = 1.0e-08;
+  Index i("i", 6), j("j", 4), k("k", 5);
+  auto T = randomTensor(i, j, k);
+
+  WarmStartSvdSolver solver = WarmStartSvdSolver();
+  ITensor U(i, j), D, V;
+  svd(T, U, D, V, solver, {"Truncate", false});
+
+  EXPECT_TRUE(norm(T - U * D * V) < eps);
+}
+
+// Leading singular triplets from the guess of a slightly perturbed matrix
+TEST(SvdWarmStartReal1, Default_cotr) {
+  double eps = 1.0e-06;
+  int maxm = 4;
+  Index i("i", 40), j("j", 30), l("l", 8);
+  auto T = randomTensor(i, l) * randomTensor(l, j);
+  auto T0 = T + 1.0e-4 * randomTensor(i, j);
+
+  SvdSolver ref_solver = SvdSolver();
+  ITensor U0(i), D0, V0;
+  svd(T0, U0, D0, V0, ref_solver, {"Maxm", maxm});
+
+  ITensor Ur(i), Dr, Vr;
+  svd(T, Ur, Dr, Vr, ref_solver, {"Maxm", maxm});
+
+  WarmStartSvdSolver solver = WarmStartSvdSolver();
+  ITensor U(i), D, V;
+  svd(T, U, D, V, U0, solver,
+      {"Maxm", maxm, "rsvd_oversampling", 4, "warmstart_iter", 2});
+
+  auto ld = commonIndex(U, D);
+  auto ldr = commonIndex(Ur, Dr);
+  ASSERT_EQ(ld.m(), ldr.m());
+  for (int s = 1; s <= ld.m(); s++) {
+    auto ldp = commonIndex(D, V);
+    auto ldrp = commonIndex(Dr, Vr);
+    EXPECT_NEAR(D.real(ld(s), ldp(s)), Dr.real(ldr(s), ldrp(s)),
+                eps * Dr.real(ldr(1), ldrp(1)));
+  }
+}
+
+// A guess narrower than the subspace (after increase of chi) is padded by
+// samples seeded per call, so repeated decompositions agree exactly
+TEST(SvdWarmStartReal2, SeededPadding) {
+  int maxm = 4;
+  Index i("i", 40), j("j", 30);
+  auto T = randomTensor(i, j);
+  auto T2 = randomTensor(i, j);
+
+  SvdSolver ref_solver = SvdSolver();
+  ITensor U0(i), D0, V0;
+  svd(T, U0, D0, V0, ref_solver, {"Maxm", 2});
+
+  Args args = {"Maxm", maxm, "rsvd_oversampling", 4, "warmstart_iter", 1};
+  WarmStartSvdSolver solver = WarmStartSvdSolver();
+  ITensor U1(i), D1, V1, U2(i), D2, V2, U3(i), D3, V3;
+  svd(T, U1, D1, V1, U0, solver, args);
+  svd(T2, U3, D3, V3, U0, solver, args);
+  svd(T, U2, D2, V2, U0, solver, args);
+
+  auto l1 = commonIndex(U1, D1), l1p = commonIndex(D1, V1);
+  auto l2 = commonIndex(U2, D2), l2p = commonIndex(D2, V2);
+  ASSERT_EQ(l1.m(), l2.m());
+  for (int s = 1; s <= l1.m(); s++)
+    EXPECT_EQ(D1.real(l1(s), l1p(s)), D2.real(l2(s), l2p(s)));
+}